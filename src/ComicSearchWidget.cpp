@@ -4,20 +4,56 @@
 #include <QCompleter>
 #include <QFile>
 #include <QHBoxLayout>
+#include <QImage>
 #include <QLineEdit>
 #include <QListWidget>
 #include <QPixmap>
 #include <QVBoxLayout>
+#include <algorithm>
 
-ComicSearchWidget::ComicSearchWidget(const QStringList& tags, QWidget* parent)
-    : QWidget(parent), modeBox(new QComboBox), edit(new QLineEdit), gallery(new QListWidget) {
+#include "ImageScaler.h"
+
+namespace {
+
+// Rows are pulled from the cursor this many at a time, only once the thumbnails of
+// the previous page have been queued.
+constexpr qsizetype RESULT_PAGE = 64;
+
+// Typical strip shapes, for comics whose size has not been indexed yet.
+constexpr QSize DAILY_STRIP(900, 280);
+constexpr QSize SUNDAY_STRIP(900, 630);
+
+QSize stripShape(const ComicItem& comic) {
+    if (comic.size.isValid()) return comic.size;
+    return comic.date.dayOfWeek() == Qt::Sunday ? SUNDAY_STRIP : DAILY_STRIP;
+}
+
+// Dailies are a single row of panels, well over twice as wide as they are tall.
+bool isSunday(const ComicItem& comic) {
+    const QSize shape = stripShape(comic);
+    return shape.height() * 2 > shape.width();
+}
+
+}  // namespace
+
+ComicSearchWidget::ComicSearchWidget(const ComicLibrary& library, const QStringList& tags,
+                                     QWidget* parent)
+    : QWidget(parent),
+      modeBox(new QComboBox),
+      formatBox(new QComboBox),
+      edit(new QLineEdit),
+      gallery(new QListWidget),
+      tagModel(new QStringListModel(tags, this)),
+      library(library) {
     modeBox->addItems({"Tag", "Date", "Transcript"});
+    formatBox->addItems({"All strips", "Dailies", "Sundays"});
 
-    edit->setCompleter(new QCompleter(tags, this));
+    edit->setCompleter(new QCompleter(tagModel, this));
 
     auto* bar = new QHBoxLayout;
     bar->addWidget(modeBox);
     bar->addWidget(edit);
+    bar->addWidget(formatBox);
 
     gallery->setViewMode(QListView::IconMode);
     gallery->setIconSize({150, 150});
@@ -29,17 +65,23 @@ ComicSearchWidget::ComicSearchWidget(const QStringList& tags, QWidget* parent)
 
     connect(edit, &QLineEdit::returnPressed, this, &ComicSearchWidget::onReturnPressed);
     connect(gallery, &QListWidget::itemClicked, this, &ComicSearchWidget::onItemClicked);
+
+    // Repeating the search is cheap: the repository replays the rows already read from
+    // its cache, however far the gallery got.
+    connect(formatBox, &QComboBox::currentIndexChanged, this, [this] {
+        if (!edit->text().trimmed().isEmpty()) onReturnPressed();
+    });
 }
 
 void ComicSearchWidget::onReturnPressed() {
     emit searchRequested(edit->text().trimmed(), static_cast<Mode>(modeBox->currentIndex()));
 }
 
-void ComicSearchWidget::showResults(const QList<ComicItem>& comics) {
+void ComicSearchWidget::showResults(ComicCursor comics) {
     gallery->clear();
     pending.clear();
-
-    for (const ComicItem& comic : comics) pending.enqueue(comic);
+    shown = 0;
+    results = std::move(comics);
 
     if (!thumbTimer.isActive()) {
         connect(&thumbTimer, &QTimer::timeout, this, &ComicSearchWidget::loadNextThumbnail,
@@ -49,23 +91,89 @@ void ComicSearchWidget::showResults(const QList<ComicItem>& comics) {
     thumbTimer.start(0);
 }
 
+void ComicSearchWidget::clearResults() {
+    thumbTimer.stop();
+    gallery->clear();
+    pending.clear();
+    shown = 0;
+    results = ComicCursor();
+}
+
 void ComicSearchWidget::setInput(const QString& str) { edit->setText(str); }
 
+void ComicSearchWidget::updateTags(const QStringList& added, const QStringList& removed) {
+    for (const QString& tag : removed) {
+        const qsizetype row = tagModel->stringList().indexOf(tag);
+        if (row >= 0) tagModel->removeRows(row, 1);
+    }
+
+    for (const QString& tag : added) {
+        const QStringList current = tagModel->stringList();
+        if (current.contains(tag)) continue;
+
+        const auto pos = std::lower_bound(current.begin(), current.end(), tag);
+        const int row = static_cast<int>(pos - current.begin());
+        tagModel->insertRows(row, 1);
+        tagModel->setData(tagModel->index(row), tag);
+    }
+}
+
+bool ComicSearchWidget::wanted(const ComicItem& comic) const {
+    switch (formatBox->currentIndex()) {
+        case Dailies:
+            return !isSunday(comic);
+        case Sundays:
+            return isSunday(comic);
+        default:
+            return true;
+    }
+}
+
+QPixmap ComicSearchWidget::placeholder(const ComicItem& comic) {
+    const QSize size = stripShape(comic).scaled(gallery->iconSize(), Qt::KeepAspectRatio);
+    const quint64 key = quint64(size.width()) << 32 | quint32(size.height());
+
+    auto it = placeholders.find(key);
+    if (it == placeholders.end()) {
+        QPixmap blank(size);
+        blank.fill(palette().color(QPalette::AlternateBase));
+        it = placeholders.insert(key, blank);
+    }
+    return *it;
+}
+
+void ComicSearchWidget::queuePage() {
+    // Rows carry their indexed sizes, so a whole page is laid out at once and the
+    // thumbnails fill in without moving anything. Only one page is read per call: when
+    // the format filter rejects all of it, the next timer tick reads on.
+    for (const ComicItem& comic : results.nextPage(RESULT_PAGE)) {
+        if (!wanted(comic)) continue;
+
+        auto* item = new QListWidgetItem(QIcon(placeholder(comic)), QString());
+        item->setData(Qt::UserRole, comic.date);
+        gallery->addItem(item);
+        pending.enqueue({item, comic});
+    }
+}
+
 void ComicSearchWidget::loadNextThumbnail() {
+    if (pending.isEmpty()) queuePage();
+
     if (pending.isEmpty()) {
-        thumbTimer.stop();
+        if (results.atEnd()) thumbTimer.stop();
         return;
     }
 
-    const ComicItem comic = pending.dequeue();
-    if (!QFile::exists(comic.path)) return;
-
-    QPixmap pix(comic.path);
-    auto* item = new QListWidgetItem(
-        QIcon(pix.scaled(150, 150, Qt::KeepAspectRatio, Qt::SmoothTransformation)), QString());
+    const auto [item, comic] = pending.dequeue();
+    const QString path = library.resolve(comic.path);
+    if (!QFile::exists(path)) {
+        delete item;
+        return;
+    }
 
-    item->setData(Qt::UserRole, comic.date);
-    gallery->addItem(item);
+    const QImage strip(path);
+    item->setIcon(QIcon(QPixmap::fromImage(ImageScaler::scaled(strip, gallery->iconSize()))));
+    ++shown;
 }
 
 void ComicSearchWidget::onItemClicked(QListWidgetItem* item) {
@@ -1,24 +1,36 @@
 #pragma once
 #include <QComboBox>
 #include <QDate>
+#include <QHash>
 #include <QLineEdit>
 #include <QListWidget>
 #include <QListWidgetItem>
+#include <QPair>
+#include <QPixmap>
 #include <QQueue>
+#include <QStringListModel>
 #include <QTimer>
 #include <QWidget>
 
+#include "ComicCursor.h"
 #include "ComicItem.h"
+#include "ComicLibrary.h"
 
 class ComicSearchWidget : public QWidget {
     Q_OBJECT
 public:
-    explicit ComicSearchWidget(const QStringList& tags, QWidget* parent = nullptr);
+    ComicSearchWidget(const ComicLibrary& library, const QStringList& tags,
+                      QWidget* parent = nullptr);
 
     enum Mode { Tag, Date, Transcript };
 
-    void showResults(const QList<ComicItem>& comics);
+    // Takes over the cursor and pulls a page at a time as thumbnails are shown.
+    void showResults(ComicCursor comics);
+    // Drops the gallery and the cursor behind it.
+    void clearResults();
     void setInput(const QString& str);
+    int thumbnailsShown() const { return shown; }
+    void updateTags(const QStringList& added, const QStringList& removed);
 
 signals:
     void searchRequested(const QString& query, Mode mode);
@@ -30,10 +42,22 @@ private slots:
     void loadNextThumbnail();
 
 private:
+    enum Format { AllStrips, Dailies, Sundays };
+
+    void queuePage();
+    bool wanted(const ComicItem& comic) const;
+    QPixmap placeholder(const ComicItem& comic);
+
     QComboBox* modeBox;
+    QComboBox* formatBox;
     QLineEdit* edit;
     QListWidget* gallery;
+    QStringListModel* tagModel;
 
-    QQueue<ComicItem> pending;
+    ComicLibrary library;
+    ComicCursor results;
+    QQueue<QPair<QListWidgetItem*, ComicItem>> pending;
+    QHash<quint64, QPixmap> placeholders;
+    int shown = 0;
     QTimer thumbTimer;
 };
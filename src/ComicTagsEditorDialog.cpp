@@ -1,62 +1,162 @@
 #include "ComicTagsEditorDialog.h"
 
+#include <QHBoxLayout>
+#include <QKeyEvent>
+#include <QKeySequence>
 #include <QLineEdit>
+#include <QShortcut>
 #include <QVBoxLayout>
 
-ComicTagsEditorDialog::ComicTagsEditorDialog(const QStringList& tags, QWidget* parent)
-    : QDialog(parent), currentTags(tags) {
+ComicTagsEditorDialog::ComicTagsEditorDialog(const QDate& date, const QStringList& tags,
+                                             QWidget* parent)
+    : QDialog(parent),
+      rowsLayout(new QVBoxLayout),
+      undoBtn(new QPushButton("Undo")),
+      redoBtn(new QPushButton("Redo")) {
     setWindowTitle("Edit Tags");
     QVBoxLayout* layout = new QVBoxLayout(this);
 
-    for (const QString& tag : currentTags) {
-        QHBoxLayout* rowLayout = new QHBoxLayout;
-        QLineEdit* lineEdit = new QLineEdit(tag);
-        QPushButton* saveBtn = new QPushButton("Save");
-        QPushButton* removeBtn = new QPushButton("Remove");
+    rowsLayout->setContentsMargins(0, 0, 0, 0);
+    layout->addLayout(rowsLayout);
 
-        rowLayout->addWidget(lineEdit);
-        rowLayout->addWidget(saveBtn);
-        rowLayout->addWidget(removeBtn);
+    QPushButton* addBtn = new QPushButton("Add tag");
+    layout->addWidget(addBtn);
+    connect(addBtn, &QPushButton::clicked, this, &ComicTagsEditorDialog::promptForNewTag);
+
+    auto* history = new QHBoxLayout;
+    history->addWidget(undoBtn);
+    history->addWidget(redoBtn);
+    layout->addLayout(history);
+
+    auto undo = [this]() {
+        journal.undo();
+        refresh();
+    };
+    auto redo = [this]() {
+        journal.redo();
+        refresh();
+    };
+
+    connect(undoBtn, &QPushButton::clicked, this, undo);
+    connect(redoBtn, &QPushButton::clicked, this, redo);
+
+    // Also while a row has focus; see eventFilter().
+    auto* undoKey = new QShortcut(QKeySequence::Undo, this);
+    auto* redoKey = new QShortcut(QKeySequence::Redo, this);
+    undoKey->setContext(Qt::WidgetWithChildrenShortcut);
+    redoKey->setContext(Qt::WidgetWithChildrenShortcut);
+    connect(undoKey, &QShortcut::activated, this, undo);
+    connect(redoKey, &QShortcut::activated, this, redo);
+
+    QPushButton* closeBtn = new QPushButton("Close");
+    layout->addWidget(closeBtn);
+    connect(closeBtn, &QPushButton::clicked, this, &QDialog::accept);
 
-        connect(saveBtn, &QPushButton::clicked, this,
-                [this, tag, lineEdit]() { emit tagEdited(tag, lineEdit->text()); });
+    setLayout(layout);
+    reset(date, tags);
+}
+
+void ComicTagsEditorDialog::reset(const QDate& date, const QStringList& tags) {
+    journal = TagEditJournal(date, tags);
+    refresh();
+}
 
-        connect(removeBtn, &QPushButton::clicked, this, [this, tag]() { emit tagRemoved(tag); });
+void ComicTagsEditorDialog::commit() {
+    if (journal.isEmpty()) return;
 
-        layout->addLayout(rowLayout);
+    const TagEditJournal committed = journal;
+    journal = TagEditJournal(committed.date(), committed.tags());
+    refresh();
+
+    emit editsCommitted(committed);
+}
+
+void ComicTagsEditorDialog::done(int result) {
+    commit();
+    QDialog::done(result);
+}
+
+bool ComicTagsEditorDialog::eventFilter(QObject* watched, QEvent* event) {
+    // A line edit claims Undo and Redo for its own text, which would shadow the
+    // journal's shortcuts whenever a row has focus; leave those keys to the dialog.
+    if (event->type() == QEvent::ShortcutOverride) {
+        const auto* key = static_cast<QKeyEvent*>(event);
+        if (key->matches(QKeySequence::Undo) || key->matches(QKeySequence::Redo)) return true;
     }
 
-    QPushButton* addBtn = new QPushButton("Add tag");
-    layout->addWidget(addBtn);
+    return QDialog::eventFilter(watched, event);
+}
 
-    connect(addBtn, &QPushButton::clicked, this, [this]() {
-        QDialog addDialog(this);
-        addDialog.setWindowTitle("Add Tag");
+void ComicTagsEditorDialog::refresh() {
+    const QStringList tags = journal.tags();
+    const bool changed = tags != currentTags;
+    currentTags = tags;
 
-        QVBoxLayout* addLayout = new QVBoxLayout(&addDialog);
-        QLineEdit* addLineEdit = new QLineEdit;
-        addLineEdit->setPlaceholderText("New tag");
-        QPushButton* addTagBtn = new QPushButton("Add");
-        QPushButton* cancelBtn = new QPushButton("Cancel");
+    while (rows.size() < currentTags.size()) rows.append(createRow());
 
-        addLayout->addWidget(addLineEdit);
-        addLayout->addWidget(addTagBtn);
-        addLayout->addWidget(cancelBtn);
+    // Rows are reused by position; surplus rows are hidden rather than destroyed.
+    for (qsizetype i = 0; i < rows.size(); ++i) {
+        const bool used = i < currentTags.size();
+        if (used && rows[i].edit->text() != currentTags[i]) rows[i].edit->setText(currentTags[i]);
+        rows[i].widget->setVisible(used);
+    }
 
-        connect(addTagBtn, &QPushButton::clicked, &addDialog, [this, addLineEdit, &addDialog]() {
-            QString newTag = addLineEdit->text().trimmed();
-            if (!newTag.isEmpty()) emit tagAdded(newTag);
-            addDialog.accept();
-        });
+    undoBtn->setEnabled(journal.canUndo());
+    redoBtn->setEnabled(journal.canRedo());
 
-        connect(cancelBtn, &QPushButton::clicked, &addDialog, &QDialog::reject);
+    if (changed) emit tagsPreviewed(currentTags);
+}
+
+ComicTagsEditorDialog::Row ComicTagsEditorDialog::createRow() {
+    const qsizetype index = rows.size();
+
+    QWidget* row = new QWidget;
+    QHBoxLayout* rowLayout = new QHBoxLayout(row);
+    rowLayout->setContentsMargins(0, 0, 0, 0);
+
+    QLineEdit* lineEdit = new QLineEdit;
+    lineEdit->installEventFilter(this);
+    QPushButton* saveBtn = new QPushButton("Save");
+    QPushButton* removeBtn = new QPushButton("Remove");
+
+    rowLayout->addWidget(lineEdit);
+    rowLayout->addWidget(saveBtn);
+    rowLayout->addWidget(removeBtn);
 
-        addDialog.exec();
+    connect(saveBtn, &QPushButton::clicked, this, [this, index, lineEdit]() {
+        if (index >= currentTags.size()) return;
+        if (journal.rename(currentTags[index], lineEdit->text().trimmed())) refresh();
     });
 
-    QPushButton* closeBtn = new QPushButton("Close");
-    layout->addWidget(closeBtn);
-    connect(closeBtn, &QPushButton::clicked, this, &QDialog::accept);
+    connect(removeBtn, &QPushButton::clicked, this, [this, index]() {
+        if (index >= currentTags.size()) return;
+        if (journal.remove(currentTags[index])) refresh();
+    });
 
-    setLayout(layout);
+    rowsLayout->addWidget(row);
+    return {row, lineEdit};
+}
+
+void ComicTagsEditorDialog::promptForNewTag() {
+    QDialog addDialog(this);
+    addDialog.setWindowTitle("Add Tag");
+
+    QVBoxLayout* addLayout = new QVBoxLayout(&addDialog);
+    QLineEdit* addLineEdit = new QLineEdit;
+    addLineEdit->setPlaceholderText("New tag");
+    QPushButton* addTagBtn = new QPushButton("Add");
+    QPushButton* cancelBtn = new QPushButton("Cancel");
+
+    addLayout->addWidget(addLineEdit);
+    addLayout->addWidget(addTagBtn);
+    addLayout->addWidget(cancelBtn);
+
+    connect(addTagBtn, &QPushButton::clicked, &addDialog, [this, addLineEdit, &addDialog]() {
+        if (journal.add(addLineEdit->text().trimmed())) refresh();
+        addDialog.accept();
+    });
+
+    connect(cancelBtn, &QPushButton::clicked, &addDialog, &QDialog::reject);
+
+    addDialog.exec();
 }
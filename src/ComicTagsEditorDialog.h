@@ -1,21 +1,49 @@
 #pragma once
 
+#include <QDate>
 #include <QDialog>
+#include <QLineEdit>
 #include <QObject>
 #include <QPushButton>
 #include <QStringList>
+#include <QVBoxLayout>
 #include <QWidget>
 
+#include "TagEditJournal.h"
+
 class ComicTagsEditorDialog : public QDialog {
     Q_OBJECT
 public:
-    ComicTagsEditorDialog(const QStringList& tags, QWidget* parent = nullptr);
+    ComicTagsEditorDialog(const QDate& date, const QStringList& tags, QWidget* parent = nullptr);
+
+    void reset(const QDate& date, const QStringList& tags);
+    void commit();
+
+    const TagEditJournal& pendingEdits() const { return journal; }
+
+    void done(int result) override;
+
+protected:
+    bool eventFilter(QObject* watched, QEvent* event) override;
 
 signals:
-    void tagEdited(const QString& oldTag, const QString& newTag);
-    void tagRemoved(const QString& tag);
-    void tagAdded(const QString& tag);
+    void tagsPreviewed(const QStringList& tags);
+    void editsCommitted(const TagEditJournal& journal);
 
 private:
+    struct Row {
+        QWidget* widget;
+        QLineEdit* edit;
+    };
+
+    Row createRow();
+    void promptForNewTag();
+    void refresh();
+
+    TagEditJournal journal;
     QStringList currentTags;
+    QVBoxLayout* rowsLayout;
+    QList<Row> rows;
+    QPushButton* undoBtn;
+    QPushButton* redoBtn;
 };
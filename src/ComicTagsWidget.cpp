@@ -1,70 +1,119 @@
 #include "ComicTagsWidget.h"
 
-#include <QDialog>
-#include <QHBoxLayout>
+#include <QHash>
 #include <QLabel>
-#include <QLineEdit>
 #include <QPushButton>
-#include <QVBoxLayout>
 
 #include "ComicTagsEditorDialog.h"
 
 ComicTagsWidget::ComicTagsWidget(QWidget* parent)
-    : QWidget(parent), editor(nullptr), layout(new FlowLayout(this, 0, 6, 6)) {
+    : QWidget(parent),
+      layout(new FlowLayout(this, 0, 6, 6)),
+      editor(nullptr),
+      emptyLabel(new QLabel("No tags found", this)),
+      spacer(new QWidget(this)) {
+    emptyLabel->setStyleSheet(QString("color: %1").arg(QColor(Qt::gray).name()));
+    spacer->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Fixed);
+
     setLayout(layout);
+    rebuildLayout();
+}
+
+void ComicTagsWidget::setTags(const QDate& newDate, const QStringList& newTags) {
+    // Staged edits belong to the comic they were made on, so flush them before the
+    // editor is pointed at another strip.
+    if (editor && newDate != date) editor->commit();
+
+    // Changes from elsewhere must not clobber edits still being staged on this comic;
+    // the caller holds them back until the editor has committed or been closed.
+    if (editor && newDate == date && !editor->pendingEdits().isEmpty()) return;
+
+    date = newDate;
+    showTags(newTags);
+
+    if (editor && editor->isVisible()) editor->reset(date, tags);
 }
 
-void ComicTagsWidget::setTags(const QStringList& newTags) {
+void ComicTagsWidget::commitPending() {
+    if (editor) editor->commit();
+}
+
+void ComicTagsWidget::showTags(const QStringList& newTags) {
+    if (newTags == tags) return;
+
     tags = newTags;
 
-    QLayoutItem* item;
-    while ((item = layout->takeAt(0))) {
-        if (item->widget()) delete item->widget();
-        delete item;
+    QHash<QString, QPushButton*> reusable;
+    reusable.reserve(chips.size());
+    for (QPushButton* chip : std::as_const(chips)) reusable.insert(chip->text(), chip);
+
+    QList<QPushButton*> next;
+    next.reserve(tags.size());
+    for (const QString& tag : std::as_const(tags)) {
+        QPushButton* chip = reusable.take(tag);
+        next.append(chip ? chip : takeChip(tag));
     }
 
-    if (tags.isEmpty()) {
-        layout->addWidget(createLabel("No tags found", Qt::gray));
-        return;
+    for (QPushButton* chip : std::as_const(reusable)) releaseChip(chip);
+
+    if (next != chips) {
+        chips = next;
+        rebuildLayout();
     }
+}
 
-    for (const QString& tag : tags) {
-        layout->addWidget(createButton(tag, true, [this, tag] { emit tagSelected(tag); }));
+QPushButton* ComicTagsWidget::takeChip(const QString& text) {
+    QPushButton* chip;
+    if (!sparePool.isEmpty()) {
+        chip = sparePool.takeLast();
+        chip->setText(text);
+    } else {
+        chip = new QPushButton(text, this);
+        chip->setFlat(true);
+        connect(chip, &QPushButton::clicked, this,
+                [this, chip] { emit tagSelected(chip->text()); });
     }
 
-    QWidget* spacer = new QWidget(this);
-    spacer->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Fixed);
-    layout->addWidget(spacer);
+    chip->show();
+    return chip;
+}
 
-    if (editor && editor->isVisible()) {
-        editor->close();
-        editor->deleteLater();
-        editor = nullptr;
+void ComicTagsWidget::releaseChip(QPushButton* chip) {
+    chip->hide();
+    sparePool.append(chip);
+}
+
+void ComicTagsWidget::rebuildLayout() {
+    QLayoutItem* item;
+    while ((item = layout->takeAt(0))) delete item;
 
-        openEditDialog();
+    if (chips.isEmpty()) {
+        spacer->hide();
+        emptyLabel->show();
+        layout->addWidget(emptyLabel);
+        return;
     }
-}
 
-QWidget* ComicTagsWidget::createLabel(const QString& text, const QColor& color) {
-    auto* label = new QLabel(text);
-    label->setStyleSheet(QString("color: %1").arg(color.name()));
-    return label;
-}
+    emptyLabel->hide();
+    for (QPushButton* chip : std::as_const(chips)) layout->addWidget(chip);
 
-QPushButton* ComicTagsWidget::createButton(const QString& text, bool flat,
-                                           const std::function<void()>& onClick) {
-    auto* btn = new QPushButton(text);
-    btn->setFlat(flat);
-    connect(btn, &QPushButton::clicked, this, onClick);
-    return btn;
+    spacer->show();
+    layout->addWidget(spacer);
 }
 
 void ComicTagsWidget::openEditDialog() {
-    editor = new ComicTagsEditorDialog(tags, this);
+    if (!editor) {
+        editor = new ComicTagsEditorDialog(date, tags, this);
 
-    connect(editor, &ComicTagsEditorDialog::tagEdited, this, &ComicTagsWidget::tagEdited);
-    connect(editor, &ComicTagsEditorDialog::tagRemoved, this, &ComicTagsWidget::tagRemoved);
-    connect(editor, &ComicTagsEditorDialog::tagAdded, this, &ComicTagsWidget::tagAdded);
+        connect(editor, &ComicTagsEditorDialog::tagsPreviewed, this, &ComicTagsWidget::showTags);
+        connect(editor, &ComicTagsEditorDialog::editsCommitted, this,
+                &ComicTagsWidget::editsCommitted);
+        connect(editor, &QDialog::finished, this, &ComicTagsWidget::editorClosed);
+    } else if (!editor->isVisible()) {
+        editor->reset(date, tags);
+    }
 
     editor->show();
-}
\ No newline at end of file
+    editor->raise();
+    editor->activateWindow();
+}
@@ -1,9 +1,10 @@
 #pragma once
 
+#include <QDate>
+#include <QLabel>
 #include <QPushButton>
 #include <QStringList>
 #include <QWidget>
-#include <functional>
 
 #include "ComicTagsEditorDialog.h"
 #include "FlowLayout.h"
@@ -13,22 +14,36 @@ class ComicTagsWidget : public QWidget {
 public:
     explicit ComicTagsWidget(QWidget* parent = nullptr);
 
-    void setTags(const QStringList& newTags);
+    void setTags(const QDate& date, const QStringList& newTags);
+    const QStringList& currentTags() const { return tags; }
+    bool hasPendingEdits() const { return editor && !editor->pendingEdits().isEmpty(); }
+    // Commits whatever the editor has staged, so the database is current.
+    void commitPending();
 
 signals:
     void tagSelected(const QString& tag);
-    void tagEdited(const QString& oldTag, const QString& newTag);
-    void tagRemoved(const QString& tag);
-    void tagAdded(const QString& tag);
+    void editsCommitted(const TagEditJournal& journal);
+    // The editor was closed; anything it staged has been committed by then.
+    void editorClosed();
 
 public slots:
     void openEditDialog();
 
 private:
     FlowLayout* layout;
+    QDate date;
     QStringList tags;
     ComicTagsEditorDialog* editor;
 
-    QWidget* createLabel(const QString& text, const QColor& color = Qt::black);
-    QPushButton* createButton(const QString& text, bool flat, const std::function<void()>& onClick);
+    // Chips currently shown, in tag order, and hidden chips kept for reuse so that
+    // navigating between comics only relabels widgets instead of recreating them.
+    QList<QPushButton*> chips;
+    QList<QPushButton*> sparePool;
+    QLabel* emptyLabel;
+    QWidget* spacer;
+
+    void showTags(const QStringList& newTags);
+    QPushButton* takeChip(const QString& text);
+    void releaseChip(QPushButton* chip);
+    void rebuildLayout();
 };
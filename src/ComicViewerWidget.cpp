@@ -5,11 +5,19 @@
 #include <QPushButton>
 #include <QScreen>
 #include <QVBoxLayout>
+#include <algorithm>
 
 #include "ComicTagsWidget.h"
+#include "ImageScaler.h"
 
 ComicViewerWidget::ComicViewerWidget(QWidget* parent, ComicTagsWidget* tags)
-    : QWidget(parent), image(new QLabel), nav(new QHBoxLayout) {
+    : QWidget(parent),
+      image(new QLabel),
+      zoomView(new ComicZoomView),
+      stack(new QStackedWidget),
+      nav(new QHBoxLayout),
+      panelsBtn(new QPushButton("Panels")),
+      zoomBtn(new QPushButton("Zoom")) {
     title = new QLabel("No comic");
     title->setAlignment(Qt::AlignCenter);
     title->setFont(QFont("Arial", 24, QFont::Bold));
@@ -18,6 +26,9 @@ ComicViewerWidget::ComicViewerWidget(QWidget* parent, ComicTagsWidget* tags)
     image->setSizePolicy(QSizePolicy::MinimumExpanding, QSizePolicy::Ignored);
     image->setMinimumSize(400, 200);
 
+    stack->addWidget(image);
+    stack->addWidget(zoomView);
+
     auto* prev = new QPushButton("Previous");
     auto* rand = new QPushButton("Random");
     auto* next = new QPushButton("Next");
@@ -28,28 +39,160 @@ ComicViewerWidget::ComicViewerWidget(QWidget* parent, ComicTagsWidget* tags)
     connect(next, &QPushButton::clicked, this, &ComicViewerWidget::nextRequested);
     connect(edit, &QPushButton::clicked, tags, &ComicTagsWidget::openEditDialog);
 
+    panelsBtn->setCheckable(true);
+    connect(panelsBtn, &QPushButton::toggled, this, &ComicViewerWidget::setPanelMode);
+
+    zoomBtn->setCheckable(true);
+    connect(zoomBtn, &QPushButton::toggled, this, &ComicViewerWidget::setZoomMode);
+
     nav->addWidget(prev);
     nav->addWidget(rand);
     nav->addWidget(next);
+    nav->addWidget(panelsBtn);
+    nav->addWidget(zoomBtn);
     nav->addWidget(edit);
 
     auto* layout = new QVBoxLayout(this);
     layout->addWidget(title);
-    layout->addWidget(image, 1);
+    layout->addWidget(stack, 1);
     layout->addWidget(tags, 0, Qt::AlignBottom);
     layout->addLayout(nav);
 }
 
-void ComicViewerWidget::showComic(const QDate& date, const QPixmap& pixmap) {
-    current = pixmap;
-    title->setText("Dilbert: " + date.toString(Qt::ISODate));
-    image->setPixmap(current.scaled(image->size(), Qt::KeepAspectRatio, Qt::SmoothTransformation));
+void ComicViewerWidget::showComic(const QDate& date, const QSize& size,
+                                  const QList<QRect>& stripPanels) {
+    currentDate = date;
+    current = QImage();
+    stripSize = size;
+    loading = true;
+    indexedPanels = stripPanels;
+    panelIndex = 0;
+
+    clipPanels();
+    if (zoomMode()) zoomView->setImage(QImage());
+
+    updateTitle();
+    updateImage();
+}
+
+void ComicViewerWidget::setStrip(const QDate& date, const QImage& strip) {
+    // A later comic may have been asked for while this one was decoding.
+    if (date != currentDate || !loading) return;
+
+    current = strip;
+    stripSize = strip.size();
+    loading = false;
+
+    clipPanels();
+    panelIndex = std::min(panelIndex, std::max<qsizetype>(0, panels.size() - 1));
+    if (zoomMode()) zoomView->setImage(current);
+
+    updateTitle();
+    updateImage();
+}
+
+void ComicViewerWidget::clipPanels() {
+    // Rectangles come from the offline index; clip them in case the file has been
+    // replaced by one of a different size since.
+    panels.clear();
+    for (const QRect& panel : std::as_const(indexedPanels)) {
+        const QRect clipped = stripSize.isValid() ? panel.intersected(QRect({0, 0}, stripSize))
+                                                  : panel;
+        if (!clipped.isEmpty()) panels.append(clipped);
+    }
+}
+
+void ComicViewerWidget::setPanelMode(bool enabled) {
+    if (panelView == enabled) return;
+
+    panelView = enabled;
+    panelsBtn->setChecked(enabled);
+
+    updateTitle();
+    updateImage();
+}
+
+bool ComicViewerWidget::stepPanel(int delta) {
+    if (!showingPanel()) return false;
+
+    const qsizetype next = panelIndex + delta;
+    if (next < 0 || next >= panels.size()) return false;
+
+    panelIndex = next;
+    updateTitle();
+    updateImage();
+    return true;
+}
+
+void ComicViewerWidget::showLastPanel() {
+    if (!showingPanel()) return;
+
+    panelIndex = panels.size() - 1;
+    updateTitle();
+    updateImage();
+}
+
+void ComicViewerWidget::setZoomMode(bool enabled) {
+    if (zoomMode() == enabled) return;
+
+    // The zoom view keeps its own copy of the strip only while it is in use.
+    zoomView->setImage(enabled ? current : QImage());
+    stack->setCurrentWidget(enabled ? static_cast<QWidget*>(zoomView) : image);
+    if (enabled) zoomView->setFocus();
+
+    // Switched first, so the toggled() this emits finds the mode already set.
+    zoomBtn->setChecked(enabled);
+
+    updateImage();
+}
+
+void ComicViewerWidget::updateTitle() {
+    QString text = "Dilbert: " + currentDate.toString(Qt::ISODate);
+    if (showingPanel()) text += QString(" (%1/%2)").arg(panelIndex + 1).arg(panels.size());
+
+    title->setText(text);
 }
 
 void ComicViewerWidget::resizeEvent(QResizeEvent*) {
-    if (current.isNull()) return;
+    // The zoom view refits itself and must keep the user's zoom otherwise.
+    if (!currentDate.isValid() || zoomMode()) return;
+
+    updateImage();
+}
+
+void ComicViewerWidget::updateImage() {
+    if (zoomMode()) {
+        if (!current.isNull()) updateZoom();
+        return;
+    }
+
+    if (current.isNull()) return showPlaceholder();
+
+    // A panel is a view into the strip that is already decoded; copy() only touches
+    // the pixels of that panel.
+    const QImage source = showingPanel() ? current.copy(panels[panelIndex]) : current;
+    image->setPixmap(QPixmap::fromImage(ImageScaler::scaled(source, image->size())));
+}
+
+void ComicViewerWidget::showPlaceholder() {
+    const QSize size = showingPanel() ? panels[panelIndex].size() : stripSize;
+    if (size.isEmpty()) {
+        image->clear();
+        return;
+    }
+
+    // Same size the decoded strip will be scaled to, so nothing moves when it arrives.
+    QPixmap frame(size.scaled(image->size(), Qt::KeepAspectRatio));
+    frame.fill(palette().color(QPalette::Base));
+    image->setPixmap(frame);
+}
 
-    image->setPixmap(current.scaled(image->size(), Qt::KeepAspectRatio, Qt::SmoothTransformation));
+void ComicViewerWidget::updateZoom() {
+    if (showingPanel()) {
+        zoomView->fitRect(panels[panelIndex]);
+    } else {
+        zoomView->fitToView();
+    }
 }
 
 void ComicViewerWidget::addButton(QPushButton* newBtn) { nav->addWidget(newBtn); }
@@ -2,21 +2,40 @@
 
 #include <QDate>
 #include <QHBoxLayout>
+#include <QImage>
 #include <QLabel>
-#include <QPixmap>
 #include <QPushButton>
+#include <QStackedWidget>
 #include <QWidget>
 
 #include "ComicTagsWidget.h"
+#include "ComicZoomView.h"
 
 class ComicViewerWidget : public QWidget {
     Q_OBJECT
 public:
     explicit ComicViewerWidget(QWidget* parent = nullptr, ComicTagsWidget* tags = nullptr);
 
-    void showComic(const QDate& date, const QPixmap& pixmap);
+    // Shows a comic whose strip is still being decoded: a blank frame of the indexed
+    // size holds its place until setStrip() delivers the pixels.
+    void showComic(const QDate& date, const QSize& size, const QList<QRect>& panels = {});
+    void setStrip(const QDate& date, const QImage& strip);
+    bool isLoading() const { return loading; }
     void addButton(QPushButton* newBtn);
 
+    bool panelMode() const { return panelView; }
+    void setPanelMode(bool enabled);
+
+    // Moves by `delta` panels within the current strip; returns false when that would
+    // leave the strip (or panel mode is off) so the caller can change comics instead.
+    bool stepPanel(int delta);
+    void showLastPanel();
+
+    // Swaps the fitted image for a tiled view that can be zoomed and panned; the
+    // current panel, if any, is what it zooms to first.
+    bool zoomMode() const { return stack->currentWidget() == zoomView; }
+    void setZoomMode(bool enabled);
+
 signals:
     void previousRequested();
     void nextRequested();
@@ -28,6 +47,25 @@ protected:
 private:
     QLabel* title;
     QLabel* image;
-    QPixmap current;
+    ComicZoomView* zoomView;
+    QStackedWidget* stack;
     QHBoxLayout* nav;
+    QPushButton* panelsBtn;
+    QPushButton* zoomBtn;
+
+    QDate currentDate;
+    QImage current;
+    QSize stripSize;
+    bool loading = false;
+    QList<QRect> indexedPanels;
+    QList<QRect> panels;
+    qsizetype panelIndex = 0;
+    bool panelView = false;
+
+    bool showingPanel() const { return panelView && !panels.isEmpty(); }
+    void updateTitle();
+    void clipPanels();
+    void updateImage();
+    void showPlaceholder();
+    void updateZoom();
 };
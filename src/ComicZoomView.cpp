@@ -0,0 +1,334 @@
+#include "ComicZoomView.h"
+
+#include <QKeyEvent>
+#include <QMouseEvent>
+#include <QMutexLocker>
+#include <QPainter>
+#include <QThread>
+#include <QWheelEvent>
+#include <QtConcurrent>
+#include <algorithm>
+#include <cmath>
+
+#include "ImageScaler.h"
+
+namespace {
+
+constexpr int TILE = 256;
+constexpr qreal MAX_SCALE = 8.0;
+constexpr qreal KEY_ZOOM_STEP = 1.25;
+
+// Tiles are cached as pixmaps with their size in KiB as cost: 96 MiB is ~380 tiles,
+// several screens' worth at every level.
+constexpr int TILE_CACHE_KB = 96 * 1024;
+
+}  // namespace
+
+ComicZoomView::Pyramid::Pyramid(const QImage& base) : levels{base} {}
+
+QImage ComicZoomView::Pyramid::tile(int level, const QRect& rect) {
+    QMutexLocker lock(&mutex);
+
+    // Levels are scaled without the lock so tiles of levels that already exist never
+    // wait behind one that is being built; only publishing it takes the lock.
+    while (levels.size() <= level) {
+        const qsizetype built = levels.size();
+        const QImage prev = levels.last();
+        lock.unlock();
+
+        const QSize half((prev.width() + 1) / 2, (prev.height() + 1) / 2);
+        const QImage next = ImageScaler::scaled(prev, half, Qt::IgnoreAspectRatio);
+
+        lock.relock();
+        // Another worker may have published the same level meanwhile.
+        if (levels.size() == built) levels.append(next);
+    }
+
+    const QImage source = levels[level];
+    lock.unlock();
+
+    return source.copy(rect);
+}
+
+ComicZoomView::ComicZoomView(QWidget* parent) : QWidget(parent), tiles(TILE_CACHE_KB) {
+    setFocusPolicy(Qt::StrongFocus);
+    setCursor(Qt::OpenHandCursor);
+
+    workers.setMaxThreadCount(std::max(1, QThread::idealThreadCount() - 1));
+}
+
+ComicZoomView::~ComicZoomView() {
+    workers.clear();
+    workers.waitForDone();
+}
+
+void ComicZoomView::setImage(const QImage& image) {
+    workers.clear();
+    ++generation;
+    pending.clear();
+    tiles.clear();
+
+    levelSizes.clear();
+    pyramid.reset();
+
+    if (!image.isNull()) {
+        pyramid = std::make_shared<Pyramid>(image);
+
+        levelSizes.append(image.size());
+        while (levelSizes.last().width() > TILE || levelSizes.last().height() > TILE) {
+            const QSize& prev = levelSizes.last();
+            levelSizes.append(QSize((prev.width() + 1) / 2, (prev.height() + 1) / 2));
+        }
+    }
+
+    fitToView();
+}
+
+void ComicZoomView::fitToView() {
+    if (levelSizes.isEmpty()) {
+        update();
+        return;
+    }
+
+    const QSize base = levelSizes.first();
+    minScale = std::min(MAX_SCALE, std::min(qreal(width()) / base.width(),
+                                            qreal(height()) / base.height()));
+    scale = minScale;
+    fitted = true;
+
+    clampOffset();
+    update();
+}
+
+void ComicZoomView::fitRect(const QRectF& rect) {
+    if (levelSizes.isEmpty() || rect.isEmpty()) return;
+
+    scale = std::clamp(std::min(width() / rect.width(), height() / rect.height()), minScale,
+                       MAX_SCALE);
+    fitted = false;
+    offset = rect.center() - QPointF(width(), height()) / (2 * scale);
+
+    clampOffset();
+    update();
+}
+
+void ComicZoomView::zoomAt(const QPointF& viewPos, qreal newScale) {
+    if (levelSizes.isEmpty()) return;
+
+    const QPointF anchor = offset + viewPos / scale;
+
+    scale = std::clamp(newScale, minScale, MAX_SCALE);
+    fitted = qFuzzyCompare(scale, minScale);
+    offset = anchor - viewPos / scale;
+
+    clampOffset();
+    update();
+}
+
+void ComicZoomView::clampOffset() {
+    if (levelSizes.isEmpty()) return;
+
+    const QSizeF image = levelSizes.first();
+    const QSizeF view = QSizeF(size()) / scale;
+
+    // Centre the strip along an axis where it is smaller than the view.
+    const auto clampAxis = [](qreal pos, qreal imageLen, qreal viewLen) {
+        if (imageLen <= viewLen) return (imageLen - viewLen) / 2;
+        return std::clamp(pos, 0.0, imageLen - viewLen);
+    };
+
+    offset.setX(clampAxis(offset.x(), image.width(), view.width()));
+    offset.setY(clampAxis(offset.y(), image.height(), view.height()));
+}
+
+int ComicZoomView::levelFor(qreal zoom) const {
+    // Use the finest level that is still at least as detailed as the screen.
+    const int level = zoom >= 1 ? 0 : int(std::floor(std::log2(1 / zoom)));
+    return std::clamp(level, 0, int(levelSizes.size()) - 1);
+}
+
+QRect ComicZoomView::tileRect(int level, int tx, int ty) const {
+    return QRect(tx * TILE, ty * TILE, TILE, TILE).intersected(QRect({0, 0}, levelSizes[level]));
+}
+
+QRectF ComicZoomView::imageRect(int level, const QRectF& levelRect) const {
+    const qreal sx = qreal(levelSizes.first().width()) / levelSizes[level].width();
+    const qreal sy = qreal(levelSizes.first().height()) / levelSizes[level].height();
+
+    return {levelRect.x() * sx, levelRect.y() * sy, levelRect.width() * sx,
+            levelRect.height() * sy};
+}
+
+quint64 ComicZoomView::tileKey(int level, int tx, int ty) {
+    return (quint64(level) << 48) | (quint64(ty) << 24) | quint64(tx);
+}
+
+void ComicZoomView::requestTile(int level, int tx, int ty) {
+    const quint64 key = tileKey(level, tx, ty);
+    if (pending.contains(key) || tiles.contains(key)) return;
+
+    pending.insert(key);
+
+    const QRect rect = tileRect(level, tx, ty);
+    const quint64 requested = generation;
+
+    // Workers get their own pool: building a level runs ImageScaler's bands on the
+    // global one, which must not wait behind tile jobs.
+    QtConcurrent::run(&workers,
+                      [source = pyramid, level, rect] { return source->tile(level, rect); })
+        .then(this, [this, key, requested](const QImage& tile) {
+            if (requested != generation) return;
+
+            pending.remove(key);
+            const int cost = int(qint64(tile.width()) * tile.height() * 4 / 1024) + 1;
+            tiles.insert(key, new QPixmap(QPixmap::fromImage(tile)), cost);
+            update();
+        });
+}
+
+bool ComicZoomView::drawFallback(QPainter& painter, int level, const QRectF& area) {
+    const QRectF target((area.topLeft() - offset) * scale, area.size() * scale);
+
+    for (int l = level; l < levelSizes.size(); ++l) {
+        const qreal sx = qreal(levelSizes[l].width()) / levelSizes.first().width();
+        const qreal sy = qreal(levelSizes[l].height()) / levelSizes.first().height();
+
+        const int tx0 = int(area.left() * sx) / TILE;
+        const int ty0 = int(area.top() * sy) / TILE;
+        const int tx1 = int(std::ceil(area.right() * sx) - 1) / TILE;
+        const int ty1 = int(std::ceil(area.bottom() * sy) - 1) / TILE;
+
+        bool drewAny = false;
+        painter.save();
+        painter.setClipRect(target);
+
+        for (int ty = ty0; ty <= ty1; ++ty) {
+            for (int tx = tx0; tx <= tx1; ++tx) {
+                const QPixmap* pix = tiles.object(tileKey(l, tx, ty));
+                if (!pix) continue;
+
+                const QRectF img = imageRect(l, tileRect(l, tx, ty));
+                painter.drawPixmap(QRectF((img.topLeft() - offset) * scale, img.size() * scale),
+                                   *pix, pix->rect());
+                drewAny = true;
+            }
+        }
+
+        painter.restore();
+        if (drewAny) return true;
+    }
+
+    return false;
+}
+
+void ComicZoomView::paintEvent(QPaintEvent*) {
+    QPainter painter(this);
+    painter.fillRect(rect(), palette().window());
+
+    if (levelSizes.isEmpty()) return;
+
+    painter.setRenderHint(QPainter::SmoothPixmapTransform);
+
+    const int level = levelFor(scale);
+    const QSize levelSize = levelSizes[level];
+    const qreal sx = qreal(levelSize.width()) / levelSizes.first().width();
+    const qreal sy = qreal(levelSize.height()) / levelSizes.first().height();
+
+    const QRectF visible(offset, QSizeF(size()) / scale);
+    const int cols = (levelSize.width() + TILE - 1) / TILE;
+    const int rows = (levelSize.height() + TILE - 1) / TILE;
+
+    const int tx0 = std::max(0, int(std::floor(visible.left() * sx / TILE)));
+    const int ty0 = std::max(0, int(std::floor(visible.top() * sy / TILE)));
+    const int tx1 = std::min(cols - 1, int(std::floor(visible.right() * sx / TILE)));
+    const int ty1 = std::min(rows - 1, int(std::floor(visible.bottom() * sy / TILE)));
+
+    for (int ty = ty0; ty <= ty1; ++ty) {
+        for (int tx = tx0; tx <= tx1; ++tx) {
+            const QRectF img = imageRect(level, tileRect(level, tx, ty));
+
+            if (const QPixmap* pix = tiles.object(tileKey(level, tx, ty))) {
+                painter.drawPixmap(QRectF((img.topLeft() - offset) * scale, img.size() * scale),
+                                   *pix, pix->rect());
+            } else {
+                requestTile(level, tx, ty);
+                drawFallback(painter, level + 1, img);
+            }
+        }
+    }
+
+    // Warm the ring of tiles just outside the view so small pans find them ready.
+    for (int ty = std::max(0, ty0 - 1); ty <= std::min(rows - 1, ty1 + 1); ++ty) {
+        for (int tx = std::max(0, tx0 - 1); tx <= std::min(cols - 1, tx1 + 1); ++tx) {
+            if (ty < ty0 || ty > ty1 || tx < tx0 || tx > tx1) requestTile(level, tx, ty);
+        }
+    }
+}
+
+void ComicZoomView::resizeEvent(QResizeEvent*) {
+    if (fitted) {
+        fitToView();
+        return;
+    }
+
+    if (!levelSizes.isEmpty()) {
+        const QSize base = levelSizes.first();
+        minScale = std::min(MAX_SCALE, std::min(qreal(width()) / base.width(),
+                                                qreal(height()) / base.height()));
+        scale = std::max(scale, minScale);
+    }
+
+    clampOffset();
+}
+
+void ComicZoomView::wheelEvent(QWheelEvent* event) {
+    zoomAt(event->position(), scale * std::pow(1.0015, event->angleDelta().y()));
+    event->accept();
+}
+
+void ComicZoomView::mousePressEvent(QMouseEvent* event) {
+    if (event->button() != Qt::LeftButton) return QWidget::mousePressEvent(event);
+
+    dragging = true;
+    dragOrigin = event->position();
+    setCursor(Qt::ClosedHandCursor);
+}
+
+void ComicZoomView::mouseMoveEvent(QMouseEvent* event) {
+    if (!dragging) return;
+
+    offset -= (event->position() - dragOrigin) / scale;
+    dragOrigin = event->position();
+
+    clampOffset();
+    update();
+}
+
+void ComicZoomView::mouseReleaseEvent(QMouseEvent* event) {
+    if (event->button() != Qt::LeftButton) return QWidget::mouseReleaseEvent(event);
+
+    dragging = false;
+    setCursor(Qt::OpenHandCursor);
+}
+
+void ComicZoomView::keyPressEvent(QKeyEvent* event) {
+    const QPointF center(width() / 2.0, height() / 2.0);
+
+    switch (event->key()) {
+        case Qt::Key_Plus:
+        case Qt::Key_Equal:
+            zoomAt(center, scale * KEY_ZOOM_STEP);
+            break;
+
+        case Qt::Key_Minus:
+            zoomAt(center, scale / KEY_ZOOM_STEP);
+            break;
+
+        case Qt::Key_0:
+            fitToView();
+            break;
+
+        default:
+            QWidget::keyPressEvent(event);
+    }
+}
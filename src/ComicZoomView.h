@@ -0,0 +1,75 @@
+#pragma once
+#include <QCache>
+#include <QImage>
+#include <QMutex>
+#include <QPixmap>
+#include <QPointF>
+#include <QRectF>
+#include <QSet>
+#include <QThreadPool>
+#include <QWidget>
+#include <memory>
+
+// Zoomable, pannable view of a strip. The image is cut into tiles on a pyramid of
+// half-size levels; painting draws only the visible tiles of the level closest to
+// the current zoom, so panning and zooming never rescale the whole strip. Missing
+// tiles are prepared on worker threads and drawn from a coarser level meanwhile.
+class ComicZoomView : public QWidget {
+    Q_OBJECT
+public:
+    explicit ComicZoomView(QWidget* parent = nullptr);
+    ~ComicZoomView();
+
+    void setImage(const QImage& image);
+    void fitRect(const QRectF& rect);
+    void fitToView();
+
+    qreal zoom() const { return scale; }
+    void zoomAt(const QPointF& viewPos, qreal newScale);
+
+protected:
+    void paintEvent(QPaintEvent*) override;
+    void resizeEvent(QResizeEvent*) override;
+    void wheelEvent(QWheelEvent* event) override;
+    void mousePressEvent(QMouseEvent* event) override;
+    void mouseMoveEvent(QMouseEvent* event) override;
+    void mouseReleaseEvent(QMouseEvent* event) override;
+    void keyPressEvent(QKeyEvent* event) override;
+
+private:
+    // Level images are built on first use by whichever worker needs them; shared
+    // with the workers so it outlives a setImage() call that replaces it.
+    class Pyramid {
+    public:
+        explicit Pyramid(const QImage& base);
+        QImage tile(int level, const QRect& rect);
+
+    private:
+        QMutex mutex;
+        QList<QImage> levels;
+    };
+
+    int levelFor(qreal zoom) const;
+    QRect tileRect(int level, int tx, int ty) const;
+    QRectF imageRect(int level, const QRectF& levelRect) const;
+    void requestTile(int level, int tx, int ty);
+    bool drawFallback(QPainter& painter, int level, const QRectF& area);
+    void clampOffset();
+
+    static quint64 tileKey(int level, int tx, int ty);
+
+    std::shared_ptr<Pyramid> pyramid;
+    QList<QSize> levelSizes;
+    quint64 generation = 0;
+
+    QCache<quint64, QPixmap> tiles;
+    QSet<quint64> pending;
+    QThreadPool workers;
+
+    qreal scale = 1;
+    qreal minScale = 1;
+    bool fitted = true;
+    QPointF offset;  // image coordinates shown at the top-left corner
+    QPointF dragOrigin;
+    bool dragging = false;
+};
@@ -1,66 +1,117 @@
 #include "DilbertViewer.h"
 
+#include <QDateTime>
 #include <QFile>
+#include <QFileInfo>
 #include <QGuiApplication>
+#include <QImage>
 #include <QKeyEvent>
-#include <QPixmap>
 #include <QRandomGenerator>
+#include <QSet>
 #include <QScreen>
 #include <QSize>
 #include <QSizePolicy>
 #include <QTabWidget>
+#include <QtConcurrent>
 
 #include "ComicTagsWidget.h"
 #include "ComicViewerWidget.h"
+#include "PanelDetector.h"
+#include "PngHeader.h"
+
+namespace {
+
+struct DecodedStrip {
+    QImage strip;
+    std::optional<ComicImage> image;
+    std::optional<ComicPanels> panels;
+};
+
+// Decodes a strip and, since the pixels are at hand anyway, does what dilbert-index
+// would for it: re-reads the header of a file that is new or has changed since it
+// was indexed, and finds the panels if they are unknown or may now be stale.
+DecodedStrip decodeStrip(const QString& path, const QDate& date,
+                         const std::optional<ComicImage>& indexed, bool analysed) {
+    DecodedStrip out{QImage(path), {}, {}};
+    if (out.strip.isNull()) return out;
+
+    const QFileInfo file(path);
+    const qint64 modified = file.lastModified().toMSecsSinceEpoch();
+    const bool changed =
+        !indexed || indexed->fileSize != file.size() || indexed->modified != modified;
+
+    if (changed) {
+        if (const auto header = PngHeader::read(path))
+            out.image = ComicImage{date, header->size, file.size(), header->colorType, modified};
+    }
+
+    if (changed || !analysed) {
+        const QImage gray = out.strip.convertToFormat(QImage::Format_Grayscale8);
+        out.panels = ComicPanels{date, PanelDetector::detect(gray.constBits(), gray.width(),
+                                                             gray.height(), gray.bytesPerLine())};
+    }
+
+    return out;
+}
+
+}  // namespace
+
+DilbertViewer::DilbertViewer(const QString& libraryRoot, QWidget* parent)
+    : QMainWindow(parent),
+      library(libraryRoot),
+      repo(library.databasePath()),
+      tags(new ComicTagsWidget(this)) {
+    if (!repo.isOpen()) qFatal("Failed to open database: %s", qPrintable(repo.openError()));
+
+    // Starts watching and polling at once, so only once the database is known good.
+    changeFeed = new ComicChangeFeed(repo, this);
 
-DilbertViewer::DilbertViewer(QWidget* parent)
-    : QMainWindow(parent), repo("./Dilbert/metadata.db"), tags(new ComicTagsWidget(this)) {
     auto* tabs = new QTabWidget(this);
 
     viewer = new ComicViewerWidget(this, tags);
-    search = new ComicSearchWidget(repo.allTags(), this);
+    search = new ComicSearchWidget(library, repo.allTags(), this);
 
     tabs->addTab(viewer, "Viewer");
     tabs->addTab(search, "Search");
 
     setCentralWidget(tabs);
 
-    connect(viewer, &ComicViewerWidget::previousRequested, this,
-            [this] { loadComic(currentComicDate.addDays(-1)); });
+    connect(viewer, &ComicViewerWidget::previousRequested, this, [this] { step(-1); });
 
-    connect(viewer, &ComicViewerWidget::nextRequested, this,
-            [this] { loadComic(currentComicDate.addDays(1)); });
+    connect(viewer, &ComicViewerWidget::nextRequested, this, [this] { step(1); });
 
     connect(viewer, &ComicViewerWidget::randomRequested, this, [this] { loadComic(randomDate()); });
 
     connect(tags, &ComicTagsWidget::tagSelected, this, [this, tabs](const QString& tag) {
-        auto comics = repo.comicsForTag(tag);
-        for (ComicItem& c : comics) c.path = "./Dilbert/" + c.path;
-
-        search->showResults(comics);
+        search->showResults(repo.comicsForTag(tag));
         search->setInput(tag);
         tabs->setCurrentIndex(1);
     });
 
-    connect(tags, &ComicTagsWidget::tagEdited, this,
-            [this](const QString& oldTag, const QString& newTag) {
-                repo.editTag(oldTag, newTag);
-                tags->setTags(repo.tagsForComic(currentComicDate));
-            });
+    connect(tags, &ComicTagsWidget::editsCommitted, this, [this](const TagEditJournal& journal) {
+        if (!repo.applyTagEdits(journal.date(), journal.edits())) {
+            // The transaction was rolled back, so the staged tags shown are stale.
+            if (journal.date() == currentComicDate) mergeDeferredTags();
+            return;
+        }
 
-    connect(tags, &ComicTagsWidget::tagRemoved, this, [this](const QString& tag) {
-        repo.removeTagFromComic(currentComicDate, tag);
-        tags->setTags(repo.tagsForComic(currentComicDate));
-    });
+        if (journal.date() != currentComicDate) return;
 
-    connect(tags, &ComicTagsWidget::tagAdded, this, [this](const QString& tag) {
-        repo.addTagToComic(currentComicDate, tag);
-        tags->setTags(repo.tagsForComic(currentComicDate));
+        // The edits were applied on top of whatever other instances stored meanwhile,
+        // so in that case the database holds the merged result, not the journal.
+        if (tagsDeferred) {
+            mergeDeferredTags();
+        } else {
+            tags->setTags(currentComicDate, journal.tags());
+        }
+    });
+    connect(tags, &ComicTagsWidget::editorClosed, this, [this] {
+        if (tagsDeferred) mergeDeferredTags();
     });
 
     connect(search, &ComicSearchWidget::searchRequested, this,
             [this, tabs](const QString& q, ComicSearchWidget::Mode m) {
-                QList<ComicItem> comics;
+                ComicCursor comics;
 
                 switch (m) {
                     case ComicSearchWidget::Tag:
@@ -76,9 +127,7 @@ DilbertViewer::DilbertViewer(QWidget* parent)
                         break;
                 }
 
-                for (ComicItem& c : comics) c.path = "./Dilbert/" + c.path;
-
-                search->showResults(comics);
+                search->showResults(std::move(comics));
                 tabs->setCurrentIndex(1);
             });
 
@@ -87,16 +136,28 @@ DilbertViewer::DilbertViewer(QWidget* parent)
         tabs->setCurrentIndex(0);
     });
 
+    connect(changeFeed, &ComicChangeFeed::changesArrived, this, &DilbertViewer::applyChanges);
+
     loadComic(randomDate());
 
     resize(800, 600);
 }
 
+DilbertViewer::~DilbertViewer() {
+    // Child widgets outlive the members; nothing they hold may still read the library
+    // once `repo` has closed it.
+    search->clearResults();
+}
+
 void DilbertViewer::keyPressEvent(QKeyEvent* event) {
     if (event->key() == Qt::Key_N) {
-        loadComic(currentComicDate.addDays(1));
+        step(1);
     } else if (event->key() == Qt::Key_P) {
-        loadComic(currentComicDate.addDays(-1));
+        step(-1);
+    } else if (event->key() == Qt::Key_V) {
+        viewer->setPanelMode(!viewer->panelMode());
+    } else if (event->key() == Qt::Key_Z) {
+        viewer->setZoomMode(!viewer->zoomMode());
     } else if (event->key() == Qt::Key_R) {
         loadComic(randomDate());
     } else if (event->key() == Qt::Key_E) {
@@ -108,20 +169,91 @@ QDate DilbertViewer::randomDate() const {
     return first.addDays(QRandomGenerator::global()->bounded(first.daysTo(last)));
 }
 
-QString DilbertViewer::comicPath(const QDate& d) const {
-    return QString("./Dilbert/%1/Dilbert_%1-%2-%3.png")
-        .arg(d.year(), 4, 10, QChar('0'))
-        .arg(d.month(), 2, 10, QChar('0'))
-        .arg(d.day(), 2, 10, QChar('0'));
+void DilbertViewer::applyChanges(const QList<ComicChange>& changes) {
+    QStringList current = tags->currentTags();
+    QSet<QString> touched;
+
+    for (const ComicChange& change : changes) {
+        switch (change.kind) {
+            case ComicChange::TagAdded:
+                touched << change.tag;
+                if (change.date == currentComicDate && !current.contains(change.tag))
+                    current << change.tag;
+                break;
+
+            case ComicChange::TagRemoved:
+                touched << change.tag;
+                if (change.date == currentComicDate) current.removeAll(change.tag);
+                break;
+
+            case ComicChange::TagRenamed:
+                touched << change.tag << change.oldTag;
+                if (current.removeAll(change.oldTag) && !current.contains(change.tag))
+                    current << change.tag;
+                break;
+
+            case ComicChange::ComicAdded:
+            case ComicChange::ComicIndexed:
+                break;
+        }
+    }
+
+    // Staged edits were made against the tags shown now; patching them underneath
+    // would lose either side, so hold the remote changes until the editor settles.
+    current.sort();
+    if (tags->hasPendingEdits()) {
+        tagsDeferred = tagsDeferred || current != tags->currentTags();
+    } else {
+        tags->setTags(currentComicDate, current);
+    }
+
+    // A tag row only disappears once no comic uses it, so ask for the final state
+    // of each touched name rather than replaying the individual events.
+    QStringList added;
+    QStringList removed;
+    for (const QString& tag : std::as_const(touched)) (repo.hasTag(tag) ? added : removed) << tag;
+
+    search->updateTags(added, removed);
 }
 
-void DilbertViewer::loadComic(const QDate& date) {
-    const QString path = comicPath(date);
-    if (!QFile::exists(path)) return;
+void DilbertViewer::mergeDeferredTags() {
+    tagsDeferred = false;
+    tags->setTags(currentComicDate, repo.tagsForComic(currentComicDate));
+}
+
+void DilbertViewer::step(int delta) {
+    if (viewer->stepPanel(delta)) return;
+
+    // Stepping back past the first panel lands on the last panel of the previous strip.
+    if (loadComic(currentComicDate.addDays(delta)) && delta < 0) viewer->showLastPanel();
+}
+
+bool DilbertViewer::loadComic(const QDate& date) {
+    const QString path = library.comicPath(date);
+    if (!QFile::exists(path)) return false;
 
-    QPixmap pix(path);
     currentComicDate = date;
+    tagsDeferred = false;
+
+    // Everything but the pixels comes from the index, so the viewer lays the strip
+    // out at once and the decode runs off the UI thread.
+    const std::optional<ComicImage> indexed = repo.indexedImage(date);
+    const std::optional<QList<QRect>> panels = repo.panelsForComic(date);
+    viewer->showComic(date, indexed ? indexed->size : QSize(), panels.value_or(QList<QRect>()));
+
+    // Staged edits of the previous comic (a rename, say) may change this one's tags.
+    tags->commitPending();
+    tags->setTags(date, repo.tagsForComic(date));
+
+    // Strips the offline index has not seen, or that changed since, are indexed as
+    // they are viewed, so the next layout and panel view need no decode.
+    QtConcurrent::run(decodeStrip, path, date, indexed, panels.has_value())
+        .then(this, [this, date](const DecodedStrip& decoded) {
+            viewer->setStrip(date, decoded.strip);
+
+            if (decoded.image) repo.storeImages({*decoded.image}, {});
+            if (decoded.panels) repo.storePanels({*decoded.panels});
+        });
 
-    viewer->showComic(date, pix);
-    tags->setTags(repo.tagsForComic(date));
+    return true;
 }
@@ -2,6 +2,8 @@
 #include <QDate>
 #include <QMainWindow>
 
+#include "ComicChangeFeed.h"
+#include "ComicLibrary.h"
 #include "ComicRepository.h"
 #include "ComicSearchWidget.h"
 #include "ComicTagsWidget.h"
@@ -10,21 +12,29 @@
 class DilbertViewer : public QMainWindow {
     Q_OBJECT
 public:
-    explicit DilbertViewer(QWidget* parent = nullptr);
+    explicit DilbertViewer(const QString& libraryRoot = "./Dilbert", QWidget* parent = nullptr);
+    ~DilbertViewer() override;
 
     void keyPressEvent(QKeyEvent* event) override;
 
 private:
-    void loadComic(const QDate& date);
+    bool loadComic(const QDate& date);
+    void step(int delta);
     QDate randomDate() const;
-    QString comicPath(const QDate& date) const;
+    void applyChanges(const QList<ComicChange>& changes);
+    void mergeDeferredTags();
 
+    ComicLibrary library;
     ComicRepository repo;
     ComicViewerWidget* viewer;
     ComicSearchWidget* search;
     ComicTagsWidget* tags;
+    ComicChangeFeed* changeFeed;
 
     QDate currentComicDate;
+    // Set when other instances changed the current comic's tags while edits were
+    // still staged here; the stored tags are re-read once those edits settle.
+    bool tagsDeferred = false;
     const QDate first{1989, 4, 16};
     const QDate last{2023, 3, 12};
 };
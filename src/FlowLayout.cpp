@@ -20,7 +20,10 @@ FlowLayout::~FlowLayout() {
     while ((item = takeAt(0))) delete item;
 }
 
-void FlowLayout::addItem(QLayoutItem *item) { itemList.append(item); }
+void FlowLayout::addItem(QLayoutItem *item) {
+    itemList.append(item);
+    invalidate();
+}
 
 int FlowLayout::horizontalSpacing() const {
     if (hSpace >= 0) {
@@ -43,8 +46,18 @@ int FlowLayout::count() const { return itemList.size(); }
 QLayoutItem *FlowLayout::itemAt(int index) const { return itemList.value(index); }
 
 QLayoutItem *FlowLayout::takeAt(int index) {
-    if (index >= 0 && index < itemList.size()) return itemList.takeAt(index);
-    return nullptr;
+    if (index < 0 || index >= itemList.size()) return nullptr;
+
+    QLayoutItem *item = itemList.takeAt(index);
+    invalidate();
+    return item;
+}
+
+void FlowLayout::invalidate() {
+    sizeHints.clear();
+    geometries.clear();
+    geometryWidth = -1;
+    QLayout::invalidate();
 }
 
 Qt::Orientations FlowLayout::expandingDirections() const { return {}; }
@@ -76,12 +89,36 @@ int FlowLayout::doLayout(const QRect &rect, bool testOnly) const {
     int left, top, right, bottom;
     getContentsMargins(&left, &top, &right, &bottom);
     QRect effectiveRect = rect.adjusted(+left, +top, -right, -bottom);
-    int x = effectiveRect.x();
-    int y = effectiveRect.y();
+
+    if (geometryWidth != effectiveRect.width()) computeGeometries(effectiveRect.width());
+
+    if (!testOnly) {
+        for (qsizetype i = 0; i < itemList.size(); ++i)
+            itemList[i]->setGeometry(geometries[i].translated(effectiveRect.topLeft()));
+    }
+
+    return top + geometryHeight + bottom;
+}
+
+void FlowLayout::computeGeometries(int width) const {
+    if (sizeHints.size() != itemList.size()) {
+        sizeHints.clear();
+        sizeHints.reserve(itemList.size());
+        for (QLayoutItem *item : std::as_const(itemList)) sizeHints.append(item->sizeHint());
+    }
+
+    const int right = width - 1;
+    int x = 0;
+    int y = 0;
     int lineHeight = 0;
 
-    for (QLayoutItem *item : std::as_const(itemList)) {
-        const QWidget *wid = item->widget();
+    geometries.clear();
+    geometries.reserve(itemList.size());
+
+    for (qsizetype i = 0; i < itemList.size(); ++i) {
+        const QWidget *wid = itemList[i]->widget();
+        const QSize hint = sizeHints[i];
+
         int spaceX = horizontalSpacing();
         if (spaceX == -1)
             spaceX = wid->style()->layoutSpacing(QSizePolicy::PushButton, QSizePolicy::PushButton,
@@ -91,20 +128,22 @@ int FlowLayout::doLayout(const QRect &rect, bool testOnly) const {
             spaceY = wid->style()->layoutSpacing(QSizePolicy::PushButton, QSizePolicy::PushButton,
                                                  Qt::Vertical);
 
-        int nextX = x + item->sizeHint().width() + spaceX;
-        if (nextX - spaceX > effectiveRect.right() && lineHeight > 0) {
-            x = effectiveRect.x();
+        int nextX = x + hint.width() + spaceX;
+        if (nextX - spaceX > right && lineHeight > 0) {
+            x = 0;
             y = y + lineHeight + spaceY;
-            nextX = x + item->sizeHint().width() + spaceX;
+            nextX = x + hint.width() + spaceX;
             lineHeight = 0;
         }
 
-        if (!testOnly) item->setGeometry(QRect(QPoint(x, y), item->sizeHint()));
+        geometries.append(QRect(QPoint(x, y), hint));
 
         x = nextX;
-        lineHeight = qMax(lineHeight, item->sizeHint().height());
+        lineHeight = qMax(lineHeight, hint.height());
     }
-    return y + lineHeight - rect.y() + bottom;
+
+    geometryWidth = width;
+    geometryHeight = y + lineHeight;
 }
 
 int FlowLayout::smartSpacing(QStyle::PixelMetric pm) const {
@@ -25,12 +25,21 @@ public:
     void setGeometry(const QRect &rect) override;
     QSize sizeHint() const override;
     QLayoutItem *takeAt(int index) override;
+    void invalidate() override;
 
 private:
     int doLayout(const QRect &rect, bool testOnly) const;
+    void computeGeometries(int width) const;
     int smartSpacing(QStyle::PixelMetric pm) const;
 
     QList<QLayoutItem *> itemList;
     int hSpace;
     int vSpace;
+
+    // Size hints and line breaks are cached for the last laid out width and only
+    // recomputed when the layout is invalidated (items added, removed or resized).
+    mutable QList<QSize> sizeHints;
+    mutable QList<QRect> geometries;
+    mutable int geometryWidth = -1;
+    mutable int geometryHeight = 0;
 };
\ No newline at end of file
@@ -0,0 +1,425 @@
+#include "ImageScaler.h"
+
+#include <QList>
+#include <QtConcurrent>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <numeric>
+#include <vector>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define IMAGE_SCALER_X86
+#include <immintrin.h>
+#endif
+
+namespace {
+
+constexpr int WEIGHT_BITS = 14;
+constexpr int WEIGHT_ONE = 1 << WEIGHT_BITS;
+constexpr int ROUNDING = 1 << (WEIGHT_BITS - 1);
+
+// From this reduction on every output pixel averages the source area it covers;
+// below it a tent filter keeps small reductions sharp.
+constexpr double AREA_RATIO = 2.0;
+
+constexpr int BAND_ROWS = 16;
+constexpr qint64 PARALLEL_PIXELS = 512 * 512;
+
+// Source span and fixed-point weights for each output row or column. Every entry has
+// room for `taps` weights (an even number, padded with zeros) so the SIMD loops can
+// consume taps in pairs; `count` is the number of real source pixels.
+struct Contributions {
+    int taps = 0;
+    std::vector<int> start;
+    std::vector<int> count;
+    std::vector<int16_t> weights;
+};
+
+Contributions computeContributions(int srcSize, int dstSize) {
+    const double scale = double(srcSize) / dstSize;
+    const bool area = scale >= AREA_RATIO;
+    const double filterScale = std::max(scale, 1.0);
+    const double support = area ? scale * 0.5 : filterScale;
+
+    Contributions c;
+    c.taps = int(std::ceil(support * 2)) + 2;
+    c.taps += c.taps % 2;
+    c.start.resize(dstSize);
+    c.count.resize(dstSize);
+    c.weights.assign(size_t(dstSize) * c.taps, 0);
+
+    std::vector<double> w(c.taps);
+
+    for (int i = 0; i < dstSize; ++i) {
+        const double center = (i + 0.5) * scale;
+        const int lo = std::max(0, int(std::floor(center - support)));
+        const int hi = std::min(srcSize, int(std::ceil(center + support)));
+
+        int first = -1;
+        int n = 0;
+        double total = 0;
+        for (int j = lo; j < hi && n < c.taps; ++j) {
+            double weight;
+            if (area) {
+                weight =
+                    std::min(j + 1.0, center + support) - std::max(double(j), center - support);
+            } else {
+                weight = 1.0 - std::abs((j + 0.5 - center) / filterScale);
+            }
+
+            if (weight <= 0) {
+                if (first < 0) continue;
+                break;
+            }
+
+            if (first < 0) first = j;
+            w[n++] = weight;
+            total += weight;
+        }
+
+        if (first < 0) {
+            first = std::clamp(int(center), 0, srcSize - 1);
+            w[0] = total = 1;
+            n = 1;
+        }
+
+        // Round to fixed point and give the rounding error to the heaviest tap so
+        // every output pixel sums to exactly WEIGHT_ONE.
+        int16_t* out = &c.weights[size_t(i) * c.taps];
+        int sum = 0;
+        int heaviest = 0;
+        for (int k = 0; k < n; ++k) {
+            out[k] = int16_t(std::lround(w[k] / total * WEIGHT_ONE));
+            sum += out[k];
+            if (out[k] > out[heaviest]) heaviest = k;
+        }
+        out[heaviest] = int16_t(out[heaviest] + WEIGHT_ONE - sum);
+
+        c.start[i] = first;
+        c.count[i] = n;
+    }
+
+    return c;
+}
+
+uint8_t clampToByte(int sum) { return uint8_t(std::clamp(sum >> WEIGHT_BITS, 0, 255)); }
+
+// Vertical pass: blends `taps` source rows into one row of `width` bytes. Works on
+// raw bytes, so the same kernel serves grayscale and 32-bit pixels.
+using VerticalFn = void (*)(uint8_t* dst, const uint8_t* const* rows, const int16_t* weights,
+                            int taps, int width);
+
+void verticalTail(uint8_t* dst, const uint8_t* const* rows, const int16_t* weights, int taps,
+                  int from, int width) {
+    for (int x = from; x < width; ++x) {
+        int sum = ROUNDING;
+        for (int k = 0; k < taps; ++k) sum += weights[k] * rows[k][x];
+        dst[x] = clampToByte(sum);
+    }
+}
+
+void verticalScalar(uint8_t* dst, const uint8_t* const* rows, const int16_t* weights, int taps,
+                    int width) {
+    verticalTail(dst, rows, weights, taps, 0, width);
+}
+
+// Horizontal pass for 32-bit pixels: filters one row of source pixels into `dstWidth`
+// output pixels, all four channels at once.
+using HorizontalFn = void (*)(uint32_t* dst, const uint32_t* src, const Contributions& c,
+                              int dstWidth);
+
+void horizontalArgbScalar(uint32_t* dst, const uint32_t* src, const Contributions& c,
+                          int dstWidth) {
+    for (int i = 0; i < dstWidth; ++i) {
+        const int16_t* w = &c.weights[size_t(i) * c.taps];
+        const uint32_t* s = src + c.start[i];
+        int sum[4] = {ROUNDING, ROUNDING, ROUNDING, ROUNDING};
+
+        for (int k = 0; k < c.count[i]; ++k) {
+            for (int ch = 0; ch < 4; ++ch) sum[ch] += w[k] * int((s[k] >> (8 * ch)) & 0xff);
+        }
+
+        uint32_t px = 0;
+        for (int ch = 0; ch < 4; ++ch) px |= uint32_t(clampToByte(sum[ch])) << (8 * ch);
+        dst[i] = px;
+    }
+}
+
+void horizontalGray(uint8_t* dst, const uint8_t* src, const Contributions& c, int dstWidth) {
+    for (int i = 0; i < dstWidth; ++i) {
+        const int16_t* w = &c.weights[size_t(i) * c.taps];
+        const uint8_t* s = src + c.start[i];
+        int sum = ROUNDING;
+
+        for (int k = 0; k < c.count[i]; ++k) sum += w[k] * s[k];
+
+        dst[i] = clampToByte(sum);
+    }
+}
+
+#ifdef IMAGE_SCALER_X86
+
+__attribute__((target("sse2"))) void verticalSse2(uint8_t* dst, const uint8_t* const* rows,
+                                                  const int16_t* weights, int taps, int width) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i rounding = _mm_set1_epi32(ROUNDING);
+
+    int x = 0;
+    for (; x + 16 <= width; x += 16) {
+        __m128i acc0 = rounding, acc1 = rounding, acc2 = rounding, acc3 = rounding;
+
+        // Two rows per step: interleaving their 16-bit pixels lets madd apply both
+        // weights and sum the products in one instruction.
+        for (int k = 0; k < taps; k += 2) {
+            const __m128i w = _mm_set1_epi32((int(weights[k + 1]) << 16) | uint16_t(weights[k]));
+            const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rows[k] + x));
+            const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rows[k + 1] + x));
+
+            const __m128i aLo = _mm_unpacklo_epi8(a, zero);
+            const __m128i aHi = _mm_unpackhi_epi8(a, zero);
+            const __m128i bLo = _mm_unpacklo_epi8(b, zero);
+            const __m128i bHi = _mm_unpackhi_epi8(b, zero);
+
+            acc0 = _mm_add_epi32(acc0, _mm_madd_epi16(_mm_unpacklo_epi16(aLo, bLo), w));
+            acc1 = _mm_add_epi32(acc1, _mm_madd_epi16(_mm_unpackhi_epi16(aLo, bLo), w));
+            acc2 = _mm_add_epi32(acc2, _mm_madd_epi16(_mm_unpacklo_epi16(aHi, bHi), w));
+            acc3 = _mm_add_epi32(acc3, _mm_madd_epi16(_mm_unpackhi_epi16(aHi, bHi), w));
+        }
+
+        const __m128i lo = _mm_packs_epi32(_mm_srai_epi32(acc0, WEIGHT_BITS),
+                                           _mm_srai_epi32(acc1, WEIGHT_BITS));
+        const __m128i hi = _mm_packs_epi32(_mm_srai_epi32(acc2, WEIGHT_BITS),
+                                           _mm_srai_epi32(acc3, WEIGHT_BITS));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x), _mm_packus_epi16(lo, hi));
+    }
+
+    verticalTail(dst, rows, weights, taps, x, width);
+}
+
+// Same as the SSE2 kernel on 32 bytes per step. The unpack and pack instructions
+// work within 128-bit lanes, and since both do, the output byte order comes out right.
+__attribute__((target("avx2"))) void verticalAvx2(uint8_t* dst, const uint8_t* const* rows,
+                                                  const int16_t* weights, int taps, int width) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i rounding = _mm256_set1_epi32(ROUNDING);
+
+    int x = 0;
+    for (; x + 32 <= width; x += 32) {
+        __m256i acc0 = rounding, acc1 = rounding, acc2 = rounding, acc3 = rounding;
+
+        for (int k = 0; k < taps; k += 2) {
+            const __m256i w =
+                _mm256_set1_epi32((int(weights[k + 1]) << 16) | uint16_t(weights[k]));
+            const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rows[k] + x));
+            const __m256i b =
+                _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rows[k + 1] + x));
+
+            const __m256i aLo = _mm256_unpacklo_epi8(a, zero);
+            const __m256i aHi = _mm256_unpackhi_epi8(a, zero);
+            const __m256i bLo = _mm256_unpacklo_epi8(b, zero);
+            const __m256i bHi = _mm256_unpackhi_epi8(b, zero);
+
+            acc0 = _mm256_add_epi32(acc0, _mm256_madd_epi16(_mm256_unpacklo_epi16(aLo, bLo), w));
+            acc1 = _mm256_add_epi32(acc1, _mm256_madd_epi16(_mm256_unpackhi_epi16(aLo, bLo), w));
+            acc2 = _mm256_add_epi32(acc2, _mm256_madd_epi16(_mm256_unpacklo_epi16(aHi, bHi), w));
+            acc3 = _mm256_add_epi32(acc3, _mm256_madd_epi16(_mm256_unpackhi_epi16(aHi, bHi), w));
+        }
+
+        const __m256i lo = _mm256_packs_epi32(_mm256_srai_epi32(acc0, WEIGHT_BITS),
+                                              _mm256_srai_epi32(acc1, WEIGHT_BITS));
+        const __m256i hi = _mm256_packs_epi32(_mm256_srai_epi32(acc2, WEIGHT_BITS),
+                                              _mm256_srai_epi32(acc3, WEIGHT_BITS));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + x), _mm256_packus_epi16(lo, hi));
+    }
+
+    verticalTail(dst, rows, weights, taps, x, width);
+}
+
+__attribute__((target("sse2"))) void horizontalArgbSse2(uint32_t* dst, const uint32_t* src,
+                                                        const Contributions& c, int dstWidth) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i rounding = _mm_set1_epi32(ROUNDING);
+
+    for (int i = 0; i < dstWidth; ++i) {
+        const int16_t* w = &c.weights[size_t(i) * c.taps];
+        const uint32_t* s = src + c.start[i];
+        const int n = c.count[i];
+        __m128i acc = rounding;
+
+        // Channels of two neighbouring pixels are interleaved so one madd weights both.
+        int k = 0;
+        for (; k + 1 < n; k += 2) {
+            const __m128i px = _mm_unpacklo_epi8(_mm_cvtsi32_si128(int(s[k])),
+                                                 _mm_cvtsi32_si128(int(s[k + 1])));
+            const __m128i weight = _mm_set1_epi32((int(w[k + 1]) << 16) | uint16_t(w[k]));
+            acc = _mm_add_epi32(acc, _mm_madd_epi16(_mm_unpacklo_epi8(px, zero), weight));
+        }
+
+        if (k < n) {
+            const __m128i px = _mm_unpacklo_epi8(_mm_cvtsi32_si128(int(s[k])), zero);
+            const __m128i weight = _mm_set1_epi32(uint16_t(w[k]));
+            acc = _mm_add_epi32(acc, _mm_madd_epi16(_mm_unpacklo_epi8(px, zero), weight));
+        }
+
+        acc = _mm_srai_epi32(acc, WEIGHT_BITS);
+        acc = _mm_packs_epi32(acc, acc);
+        dst[i] = uint32_t(_mm_cvtsi128_si32(_mm_packus_epi16(acc, acc)));
+    }
+}
+
+#endif
+
+struct Kernels {
+    VerticalFn vertical;
+    HorizontalFn horizontalArgb;
+};
+
+Kernels kernelsFor(ImageScaler::Kernel kernel) {
+#ifdef IMAGE_SCALER_X86
+    if (kernel == ImageScaler::Kernel::Avx2) return {verticalAvx2, horizontalArgbSse2};
+    if (kernel == ImageScaler::Kernel::Sse2) return {verticalSse2, horizontalArgbSse2};
+#endif
+    return {verticalScalar, horizontalArgbScalar};
+}
+
+ImageScaler::Kernel bestKernel() {
+    for (const auto kernel : {ImageScaler::Kernel::Avx2, ImageScaler::Kernel::Sse2}) {
+        if (ImageScaler::isSupported(kernel)) return kernel;
+    }
+    return ImageScaler::Kernel::Scalar;
+}
+
+std::atomic<ImageScaler::Kernel> forcedKernel{ImageScaler::Kernel::Auto};
+
+const Kernels& kernels() {
+    static const Kernels byKernel[] = {kernelsFor(ImageScaler::Kernel::Scalar),
+                                       kernelsFor(ImageScaler::Kernel::Sse2),
+                                       kernelsFor(ImageScaler::Kernel::Avx2),
+                                       kernelsFor(bestKernel())};
+
+    return byKernel[int(forcedKernel.load(std::memory_order_relaxed))];
+}
+
+struct ScaleJob {
+    const uint8_t* src;
+    qsizetype srcStride;
+    int srcWidth;
+    uint8_t* dst;
+    qsizetype dstStride;
+    int dstWidth;
+    int bytesPerPixel;
+    const Contributions* columns;
+    const Contributions* rows;
+};
+
+// Scales output rows [firstRow, lastRow). Bands share nothing but read-only input, so
+// they can run on any thread.
+void scaleBand(const ScaleJob& job, int firstRow, int lastRow) {
+    const Kernels& k = kernels();
+    const Contributions& rows = *job.rows;
+    const int lineBytes = job.srcWidth * job.bytesPerPixel;
+
+    std::vector<uint8_t> line(lineBytes);
+    std::vector<const uint8_t*> sources(rows.taps);
+
+    for (int y = firstRow; y < lastRow; ++y) {
+        // Padding taps have zero weight; point them at a real row so loads stay valid.
+        for (int t = 0; t < rows.taps; ++t)
+            sources[t] = job.src + (rows.start[y] + std::min(t, rows.count[y] - 1)) * job.srcStride;
+
+        k.vertical(line.data(), sources.data(), &rows.weights[size_t(y) * rows.taps], rows.taps,
+                   lineBytes);
+
+        uint8_t* out = job.dst + y * job.dstStride;
+        if (job.bytesPerPixel == 1) {
+            horizontalGray(out, line.data(), *job.columns, job.dstWidth);
+        } else {
+            k.horizontalArgb(reinterpret_cast<uint32_t*>(out),
+                             reinterpret_cast<const uint32_t*>(line.data()), *job.columns,
+                             job.dstWidth);
+        }
+    }
+}
+
+QImage workingCopy(const QImage& src) {
+    switch (src.format()) {
+        case QImage::Format_Grayscale8:
+        case QImage::Format_RGB32:
+        case QImage::Format_ARGB32_Premultiplied:
+            return src;
+        default:
+            break;
+    }
+
+    if (src.isGrayscale() && !src.hasAlphaChannel())
+        return src.convertToFormat(QImage::Format_Grayscale8);
+
+    // Averaging needs premultiplied alpha, or transparent pixels bleed their colour.
+    return src.convertToFormat(src.hasAlphaChannel() ? QImage::Format_ARGB32_Premultiplied
+                                                     : QImage::Format_RGB32);
+}
+
+}  // namespace
+
+bool ImageScaler::isSupported(Kernel kernel) {
+    if (kernel == Kernel::Scalar || kernel == Kernel::Auto) return true;
+
+#ifdef IMAGE_SCALER_X86
+    __builtin_cpu_init();
+    if (kernel == Kernel::Avx2) return __builtin_cpu_supports("avx2");
+    if (kernel == Kernel::Sse2) return __builtin_cpu_supports("sse2");
+#endif
+    return false;
+}
+
+bool ImageScaler::setKernel(Kernel kernel) {
+    if (!isSupported(kernel)) return false;
+
+    forcedKernel.store(kernel, std::memory_order_relaxed);
+    return true;
+}
+
+QImage ImageScaler::scaled(const QImage& src, const QSize& size, Qt::AspectRatioMode mode) {
+    if (src.isNull() || size.isEmpty()) return {};
+
+    const QSize target = src.size().scaled(size, mode);
+    if (target.isEmpty()) return {};
+    if (target == src.size()) return src;
+
+    if (target.width() >= src.width() && target.height() >= src.height())
+        return src.scaled(target, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+
+    const QImage input = workingCopy(src);
+    QImage out(target, input.format());
+    if (out.isNull()) return {};
+
+    const Contributions columns = computeContributions(input.width(), target.width());
+    const Contributions rows = computeContributions(input.height(), target.height());
+
+    const ScaleJob job{input.constBits(),
+                       input.bytesPerLine(),
+                       input.width(),
+                       out.bits(),
+                       out.bytesPerLine(),
+                       target.width(),
+                       input.format() == QImage::Format_Grayscale8 ? 1 : 4,
+                       &columns,
+                       &rows};
+
+    const int bands = (target.height() + BAND_ROWS - 1) / BAND_ROWS;
+    auto scaleBandAt = [&job, &target](int band) {
+        scaleBand(job, band * BAND_ROWS, std::min(target.height(), (band + 1) * BAND_ROWS));
+    };
+
+    if (bands > 1 && qint64(input.width()) * input.height() >= PARALLEL_PIXELS) {
+        QList<int> indices(bands);
+        std::iota(indices.begin(), indices.end(), 0);
+        QtConcurrent::blockingMap(indices, scaleBandAt);
+    } else {
+        for (int band = 0; band < bands; ++band) scaleBandAt(band);
+    }
+
+    return out;
+}
@@ -0,0 +1,25 @@
+#pragma once
+#include <QImage>
+#include <QSize>
+
+// High quality downscaling for strips and thumbnails. Large reductions use an area
+// average so fine linework does not alias; small ones use a separable tent filter.
+// Grayscale8 and 32-bit images are processed natively, anything else is converted
+// first. The hot loops have SSE2 and AVX2 versions picked at runtime, and large
+// images are split into bands of rows that are scaled in parallel.
+namespace ImageScaler {
+
+QImage scaled(const QImage& src, const QSize& size,
+              Qt::AspectRatioMode mode = Qt::KeepAspectRatio);
+
+// The code paths for the hot loops. Auto takes the fastest one the CPU supports; the
+// others exist so benchmarks can compare them.
+enum class Kernel { Scalar, Sse2, Avx2, Auto };
+
+bool isSupported(Kernel kernel);
+
+// Makes every later call use `kernel`. Returns false and changes nothing when the
+// CPU (or the build) does not have it.
+bool setKernel(Kernel kernel);
+
+}  // namespace ImageScaler
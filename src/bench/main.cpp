@@ -0,0 +1,158 @@
+// dilbert-scale-bench: times ImageScaler::scaled against QImage::scaled with
+// Qt::SmoothTransformation on synthetic strips, for grayscale and ARGB sources at
+// gallery thumbnail and viewer sizes, once per code path the CPU supports.
+//
+//   dilbert-scale-bench [--iterations N]
+//
+// Prints the median time per call for each case and how many times faster than Qt
+// the scaler is.
+
+#include <QElapsedTimer>
+#include <QGuiApplication>
+#include <QImage>
+#include <QList>
+#include <QPainter>
+#include <QRandomGenerator>
+#include <QStringList>
+#include <algorithm>
+#include <cstdio>
+
+#include "ImageScaler.h"
+
+namespace {
+
+// Strips as the downloader stores them at high resolution; a Sunday is two tiers.
+constexpr QSize DAILY{1800, 560};
+constexpr QSize SUNDAY{1800, 1260};
+
+struct Target {
+    const char* name;
+    QSize size;
+};
+
+// The gallery's icon size and a typical viewer area.
+constexpr Target TARGETS[] = {
+    {"thumbnail", {150, 150}},
+    {"viewer", {1280, 720}},
+};
+
+struct Path {
+    const char* name;
+    ImageScaler::Kernel kernel;
+};
+
+constexpr Path PATHS[] = {
+    {"scalar", ImageScaler::Kernel::Scalar},
+    {"sse2", ImageScaler::Kernel::Sse2},
+    {"avx2", ImageScaler::Kernel::Avx2},
+};
+
+QImage renderStrip(const QSize& size, QImage::Format format, QRandomGenerator& rng) {
+    QImage strip(size, QImage::Format_ARGB32_Premultiplied);
+    strip.fill(Qt::white);
+
+    QPainter painter(&strip);
+    painter.setRenderHint(QPainter::Antialiasing);
+
+    // Thin dark linework on white, which is what makes aliasing visible in strips.
+    for (int i = 0; i < 400; ++i) {
+        const int shade = rng.bounded(0, 160);
+        painter.setPen(QPen(QColor(shade, shade, shade), rng.bounded(1, 5)));
+        painter.drawLine(rng.bounded(size.width()), rng.bounded(size.height()),
+                         rng.bounded(size.width()), rng.bounded(size.height()));
+        painter.drawEllipse(QRect(rng.bounded(size.width()), rng.bounded(size.height()),
+                                  rng.bounded(10, 80), rng.bounded(10, 80)));
+    }
+
+    painter.end();
+    return strip.convertToFormat(format);
+}
+
+template <typename Fn>
+double medianMs(int iterations, Fn scale) {
+    QList<double> times;
+    times.reserve(iterations);
+
+    // One untimed call so the first sample does not pay for thread pool start-up.
+    scale();
+
+    for (int i = 0; i < iterations; ++i) {
+        QElapsedTimer timer;
+        timer.start();
+        const QImage out = scale();
+        times.append(timer.nsecsElapsed() / 1e6);
+
+        if (out.isNull()) return -1;
+    }
+
+    std::sort(times.begin(), times.end());
+    return times[times.size() / 2];
+}
+
+int usage() {
+    std::fprintf(stderr, "usage: dilbert-scale-bench [--iterations N]\n");
+    return 2;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    // QPainter needs a GUI application for the synthetic strips; nothing is shown.
+    if (!qEnvironmentVariableIsSet("QT_QPA_PLATFORM")) qputenv("QT_QPA_PLATFORM", "offscreen");
+
+    QGuiApplication app(argc, argv);
+
+    int iterations = 30;
+
+    const QStringList args = app.arguments().mid(1);
+    if (!args.isEmpty()) {
+        bool ok = false;
+        if (args.size() == 2 && args[0] == "--iterations") iterations = args[1].toInt(&ok);
+        if (!ok || iterations < 1) return usage();
+    }
+
+    QRandomGenerator rng(1);
+
+    struct Source {
+        const char* name;
+        QImage image;
+    };
+
+    const Source sources[] = {
+        {"gray daily", renderStrip(DAILY, QImage::Format_Grayscale8, rng)},
+        {"gray sunday", renderStrip(SUNDAY, QImage::Format_Grayscale8, rng)},
+        {"argb daily", renderStrip(DAILY, QImage::Format_ARGB32_Premultiplied, rng)},
+        {"argb sunday", renderStrip(SUNDAY, QImage::Format_ARGB32_Premultiplied, rng)},
+    };
+
+    std::printf("%-12s %-10s %-7s %9s %9s %8s\n", "source", "target", "path", "ms", "qt ms",
+                "speedup");
+
+    bool failed = false;
+    for (const Source& source : sources) {
+        for (const Target& target : TARGETS) {
+            const double qtMs = medianMs(iterations, [&] {
+                return source.image.scaled(target.size, Qt::KeepAspectRatio,
+                                           Qt::SmoothTransformation);
+            });
+
+            for (const Path& path : PATHS) {
+                if (!ImageScaler::setKernel(path.kernel)) {
+                    std::printf("%-12s %-10s %-7s %9s\n", source.name, target.name, path.name,
+                                "n/a");
+                    continue;
+                }
+
+                const double ms = medianMs(
+                    iterations, [&] { return ImageScaler::scaled(source.image, target.size); });
+                failed = failed || ms < 0;
+
+                std::printf("%-12s %-10s %-7s %9.3f %9.3f %7.2fx\n", source.name, target.name,
+                            path.name, ms, qtMs, ms > 0 ? qtMs / ms : 0.0);
+            }
+        }
+    }
+
+    ImageScaler::setKernel(ImageScaler::Kernel::Auto);
+    return failed ? 1 : 0;
+}
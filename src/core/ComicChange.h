@@ -0,0 +1,15 @@
+#pragma once
+#include <QDate>
+#include <QString>
+
+// One entry of the change_log table, written by triggers for every tag, comic or
+// image index change regardless of which process made it.
+struct ComicChange {
+    enum Kind { TagAdded, TagRemoved, TagRenamed, ComicAdded, ComicIndexed };
+
+    qint64 seq;
+    Kind kind;
+    QDate date;
+    QString tag;
+    QString oldTag;
+};
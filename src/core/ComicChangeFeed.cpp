@@ -0,0 +1,53 @@
+#include "ComicChangeFeed.h"
+
+#include <QFile>
+
+namespace {
+
+constexpr int DEBOUNCE_MS = 50;
+// File notifications are unreliable on some (network) filesystems; an occasional
+// poll of MAX(seq) keeps those instances in sync too.
+constexpr int FALLBACK_POLL_MS = 2000;
+
+}  // namespace
+
+ComicChangeFeed::ComicChangeFeed(ComicRepository& repo, QObject* parent)
+    : QObject(parent), repo(repo), lastSeq(repo.lastChangeSeq()) {
+    debounce.setSingleShot(true);
+    debounce.setInterval(DEBOUNCE_MS);
+    fallback.setInterval(FALLBACK_POLL_MS);
+
+    connect(&watcher, &QFileSystemWatcher::fileChanged, this, [this] {
+        watchFiles();
+        debounce.start();
+    });
+    connect(&debounce, &QTimer::timeout, this, &ComicChangeFeed::poll);
+    connect(&fallback, &QTimer::timeout, this, &ComicChangeFeed::poll);
+
+    watchFiles();
+    fallback.start();
+}
+
+void ComicChangeFeed::watchFiles() {
+    // In WAL mode commits land in the -wal file; it can be recreated after a
+    // checkpoint, which silently drops the watch, so re-add whatever exists.
+    const QString db = repo.databasePath();
+    for (const QString& path : {db, db + "-wal"}) {
+        if (QFile::exists(path) && !watcher.files().contains(path)) watcher.addPath(path);
+    }
+}
+
+void ComicChangeFeed::poll() {
+    const qint64 latest = repo.lastChangeSeq();
+    if (latest <= lastSeq) return;
+
+    // Advance past our own commits as well, even when they are all there is.
+    const QList<ComicChange> changes = repo.changesSince(lastSeq, latest);
+    lastSeq = latest;
+    if (changes.isEmpty()) return;
+
+    // Commits from other processes only become visible here; ours have already
+    // bumped the generation, and a second bump is harmless.
+    repo.invalidateResults();
+    emit changesArrived(changes);
+}
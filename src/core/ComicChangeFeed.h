@@ -0,0 +1,31 @@
+#pragma once
+#include <QFileSystemWatcher>
+#include <QList>
+#include <QObject>
+#include <QTimer>
+
+#include "ComicChange.h"
+#include "ComicRepository.h"
+
+// Watches the database files for commits from any process and reports the new
+// change_log entries, so each instance can patch its state instead of reloading.
+class ComicChangeFeed : public QObject {
+    Q_OBJECT
+public:
+    explicit ComicChangeFeed(ComicRepository& repo, QObject* parent = nullptr);
+
+public slots:
+    void poll();
+
+signals:
+    void changesArrived(const QList<ComicChange>& changes);
+
+private:
+    void watchFiles();
+
+    ComicRepository& repo;
+    QFileSystemWatcher watcher;
+    QTimer debounce;
+    QTimer fallback;
+    qint64 lastSeq;
+};
@@ -0,0 +1,84 @@
+#include "ComicCursor.h"
+
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <utility>
+
+ComicCursor::ComicCursor(Query query, const QList<ComicItem>& known)
+    : query(std::move(query)), replay(known) {
+    done = false;
+}
+
+ComicCursor::ComicCursor(const QList<ComicItem>& comics) : replay(comics) {
+    done = comics.isEmpty();
+}
+
+void ComicCursor::record(Recorder onPage) { recorder = std::move(onPage); }
+
+QList<ComicItem> ComicCursor::nextPage(qsizetype maxRows) {
+    QList<ComicItem> page;
+    if (done) return page;
+
+    if (read < replay.size()) {
+        page = replay.mid(read, maxRows);
+        read += page.size();
+        if (!page.isEmpty()) last = page.last().date;
+
+        // Without a query the replay is the whole result.
+        done = read >= replay.size() && query.sql.isEmpty();
+        return page;
+    }
+
+    page = fetch(maxRows);
+    read += page.size();
+    if (!page.isEmpty()) last = page.last().date;
+
+    if (recorder) recorder(read - page.size(), page, done);
+
+    return page;
+}
+
+QList<ComicItem> ComicCursor::fetch(qsizetype maxRows) {
+    QList<ComicItem> page;
+
+    QSqlQuery q(QSqlDatabase::database(query.connection, false));
+    q.setForwardOnly(true);
+    if (!q.prepare(query.sql)) {
+        done = true;
+        return page;
+    }
+
+    for (auto it = query.values.cbegin(); it != query.values.cend(); ++it)
+        q.bindValue(it.key(), it.value());
+
+    // Nothing sorts before an empty string or a negative day.
+    if (query.key == IsoDate) {
+        q.bindValue(":after", last.isValid() ? last.toString(Qt::ISODate) : QString(""));
+    } else {
+        q.bindValue(":after", last.isValid() ? last.toJulianDay() : qint64(-1));
+    }
+    q.bindValue(":limit", maxRows);
+
+    if (!q.exec()) {
+        done = true;
+        return page;
+    }
+
+    page.reserve(maxRows);
+    while (q.next()) {
+        QSize size;
+        if (!q.isNull(2)) size = QSize(q.value(2).toInt(), q.value(3).toInt());
+
+        page.append(
+            {QDate::fromJulianDay(q.value(0).toLongLong()), q.value(1).toString(), size});
+    }
+
+    // A short page was the last one. Either way the statement ends with `q`, so no read
+    // snapshot outlives this call.
+    done = page.size() < maxRows;
+    return page;
+}
+
+qsizetype ComicCursor::rowBytes(const ComicItem& comic) {
+    return qsizetype(sizeof(ComicItem)) + comic.path.size() * qsizetype(sizeof(QChar));
+}
@@ -0,0 +1,73 @@
+#pragma once
+#include <QList>
+#include <QString>
+#include <QVariantMap>
+#include <functional>
+
+#include "ComicItem.h"
+
+// Forward-only view over the result of a comic query, read a page at a time so the
+// first page is ready before the whole result is known and memory stays bounded by
+// the page size. Paths are left relative to the library root.
+//
+// Every page is a statement of its own that continues after the last row handed out
+// (keyset paging) and is finished before nextPage() returns, so an idle cursor holds
+// no read snapshot on the connection. The cursor only names that connection; once
+// the repository has closed it, the next page comes back empty.
+class ComicCursor {
+public:
+    // Handed every page read from the database: the rows before it, the page, and
+    // whether it was the last one.
+    using Recorder =
+        std::function<void(qsizetype offset, const QList<ComicItem>& page, bool complete)>;
+
+    // What the rows are ordered by, and so what :after is bound to.
+    enum Key { Day, IsoDate };
+
+    // A paged search. `sql` selects day, image path and the indexed width and height,
+    // in that order, of the rows after :after in key order, at most :limit of them.
+    struct Query {
+        QString connection;
+        QString sql;
+        QVariantMap values;
+        Key key = Day;
+    };
+
+    ComicCursor() = default;
+
+    // Hands out `known`, the start of the result already held in memory, before
+    // reading on from the database after its last row.
+    explicit ComicCursor(Query query, const QList<ComicItem>& known = {});
+
+    // Replays a result that is already in memory in full, such as a cached one.
+    explicit ComicCursor(const QList<ComicItem>& comics);
+
+    ComicCursor(ComicCursor&&) = default;
+    ComicCursor& operator=(ComicCursor&&) = default;
+    ComicCursor(const ComicCursor&) = delete;
+    ComicCursor& operator=(const ComicCursor&) = delete;
+
+    // Reports each page as it is read from the database, so whatever part of the
+    // result gets read can be kept.
+    void record(Recorder onPage);
+
+    // Returns up to maxRows further comics; an empty page means the result is done.
+    QList<ComicItem> nextPage(qsizetype maxRows);
+
+    bool atEnd() const { return done; }
+    qsizetype rowsRead() const { return read; }
+
+    // Approximate memory held by a row, for byte budgets.
+    static qsizetype rowBytes(const ComicItem& comic);
+
+private:
+    QList<ComicItem> fetch(qsizetype maxRows);
+
+    Query query;
+    QList<ComicItem> replay;
+    QDate last;
+    qsizetype read = 0;
+    bool done = true;
+
+    Recorder recorder;
+};
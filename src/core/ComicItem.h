@@ -1,8 +1,10 @@
 #pragma once
 #include <QDate>
+#include <QSize>
 #include <QString>
 
 struct ComicItem {
     QDate date;
     QString path;
+    QSize size;  // from the image index; invalid until the strip has been scanned
 };
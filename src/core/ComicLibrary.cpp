@@ -0,0 +1,19 @@
+#include "ComicLibrary.h"
+
+ComicLibrary::ComicLibrary(const QString& root) : rootDir(root) {
+    while (rootDir.size() > 1 && rootDir.endsWith('/')) rootDir.chop(1);
+}
+
+QString ComicLibrary::databasePath() const { return rootDir + "/metadata.db"; }
+
+QString ComicLibrary::comicPath(const QDate& d) const {
+    return QString("%1/%2/Dilbert_%2-%3-%4.png")
+        .arg(rootDir)
+        .arg(d.year(), 4, 10, QChar('0'))
+        .arg(d.month(), 2, 10, QChar('0'))
+        .arg(d.day(), 2, 10, QChar('0'));
+}
+
+QString ComicLibrary::resolve(const QString& relativePath) const {
+    return rootDir + '/' + relativePath;
+}
@@ -0,0 +1,20 @@
+#pragma once
+#include <QDate>
+#include <QString>
+
+// A downloaded comic collection: the metadata database plus one strip per day,
+// stored as <root>/<year>/Dilbert_<date>.png. Paths in the database are relative
+// to the root.
+class ComicLibrary {
+public:
+    explicit ComicLibrary(const QString& root = "./Dilbert");
+
+    const QString& root() const { return rootDir; }
+    QString databasePath() const;
+
+    QString comicPath(const QDate& date) const;
+    QString resolve(const QString& relativePath) const;
+
+private:
+    QString rootDir;
+};
@@ -0,0 +1,896 @@
+#include "ComicRepository.h"
+
+#include <QDebug>
+#include <QtSql>
+
+namespace {
+
+// SQLite waits this long for another writer before giving up. It is the only wait:
+// writes run on the UI thread, so nothing may sleep on top of it.
+constexpr int BUSY_TIMEOUT_MS = 5000;
+constexpr int CHANGE_LOG_KEEP = 10000;
+
+// Search results are cached by their size in bytes; results larger than a quarter
+// of the budget are not kept, so one huge search cannot flush all the others.
+constexpr int RESULT_CACHE_BYTES = 8 << 20;
+constexpr qsizetype MAX_CACHED_RESULT_BYTES = RESULT_CACHE_BYTES / 4;
+
+ComicChange::Kind changeKind(const QString& kind) {
+    if (kind == "tag_removed") return ComicChange::TagRemoved;
+    if (kind == "tag_renamed") return ComicChange::TagRenamed;
+    if (kind == "comic_added") return ComicChange::ComicAdded;
+    if (kind == "comic_indexed") return ComicChange::ComicIndexed;
+    return ComicChange::TagAdded;
+}
+
+// Day number matching QDate::toJulianDay(); julianday() counts from noon.
+#define DAY_KEY(col) "CAST(julianday(" col ") + 0.5 AS INTEGER)"
+
+struct Migration {
+    int version;
+    QStringList statements;
+};
+
+// Applied in order, each in its own transaction; PRAGMA user_version records the last
+// one applied. Never edit a released migration, append a new one instead.
+const QList<Migration> MIGRATIONS = {
+    {1,
+     {
+         "CREATE TABLE IF NOT EXISTS comics ("
+         "date TEXT PRIMARY KEY, "
+         "image_path TEXT, "
+         "transcript TEXT)",
+
+         "CREATE TABLE IF NOT EXISTS tags ("
+         "id INTEGER PRIMARY KEY AUTOINCREMENT, "
+         "name TEXT UNIQUE)",
+
+         "CREATE TABLE IF NOT EXISTS comic_tags ("
+         "comic_date TEXT, "
+         "tag_id INTEGER, "
+         "PRIMARY KEY (comic_date, tag_id), "
+         "FOREIGN KEY (comic_date) REFERENCES comics(date), "
+         "FOREIGN KEY (tag_id) REFERENCES tags(id))",
+     }},
+    {2,
+     {
+         "CREATE TABLE IF NOT EXISTS change_log ("
+         "seq INTEGER PRIMARY KEY AUTOINCREMENT, "
+         "kind TEXT NOT NULL, "
+         "comic_date TEXT, "
+         "tag TEXT, "
+         "old_tag TEXT)",
+
+         "CREATE TRIGGER IF NOT EXISTS change_log_tag_added AFTER INSERT ON comic_tags BEGIN "
+         "INSERT INTO change_log(kind, comic_date, tag) "
+         "VALUES('tag_added', NEW.comic_date, (SELECT name FROM tags WHERE id = NEW.tag_id)); "
+         "END",
+
+         "CREATE TRIGGER IF NOT EXISTS change_log_tag_removed AFTER DELETE ON comic_tags BEGIN "
+         "INSERT INTO change_log(kind, comic_date, tag) "
+         "VALUES('tag_removed', OLD.comic_date, (SELECT name FROM tags WHERE id = OLD.tag_id)); "
+         "END",
+
+         "CREATE TRIGGER IF NOT EXISTS change_log_tag_moved AFTER UPDATE OF tag_id ON comic_tags "
+         "BEGIN "
+         "INSERT INTO change_log(kind, comic_date, tag) "
+         "VALUES('tag_removed', OLD.comic_date, (SELECT name FROM tags WHERE id = OLD.tag_id)); "
+         "INSERT INTO change_log(kind, comic_date, tag) "
+         "VALUES('tag_added', NEW.comic_date, (SELECT name FROM tags WHERE id = NEW.tag_id)); "
+         "END",
+
+         "CREATE TRIGGER IF NOT EXISTS change_log_tag_renamed AFTER UPDATE OF name ON tags BEGIN "
+         "INSERT INTO change_log(kind, tag, old_tag) VALUES('tag_renamed', NEW.name, OLD.name); "
+         "END",
+
+         "CREATE TRIGGER IF NOT EXISTS change_log_comic_added AFTER INSERT ON comics BEGIN "
+         "INSERT INTO change_log(kind, comic_date) VALUES('comic_added', NEW.date); "
+         "END",
+     }},
+    {3,
+     {
+         // Integer day key so rows convert with QDate::fromJulianDay instead of parsing.
+         // The downloader does not know about it, hence the triggers filling it in.
+         "ALTER TABLE comics ADD COLUMN day INTEGER",
+         "UPDATE comics SET day = " DAY_KEY("date"),
+
+         "CREATE TRIGGER comics_day_insert AFTER INSERT ON comics WHEN NEW.day IS NULL BEGIN "
+         "UPDATE comics SET day = " DAY_KEY("NEW.date") " WHERE rowid = NEW.rowid; "
+         "END",
+
+         "CREATE TRIGGER comics_day_update AFTER UPDATE OF date ON comics BEGIN "
+         "UPDATE comics SET day = " DAY_KEY("NEW.date") " WHERE rowid = NEW.rowid; "
+         "END",
+
+         // Covering indexes: tag lookups seek by tag_id and come out in date order,
+         // and comic rows are resolved by date or day without touching the table.
+         "CREATE INDEX comic_tags_tag ON comic_tags(tag_id, comic_date)",
+         "CREATE INDEX comics_date_cover ON comics(date, day, image_path)",
+         "CREATE INDEX comics_day_cover ON comics(day, image_path)",
+
+         "ANALYZE",
+     }},
+    {4,
+     {
+         // Panel rectangles found by dilbert-index, as "x,y,w,h;..." in reading order.
+         // An empty string records a strip that was analysed but has no panels.
+         "CREATE TABLE comic_panels ("
+         "comic_date TEXT PRIMARY KEY, "
+         "rects TEXT NOT NULL) WITHOUT ROWID",
+     }},
+    {5,
+     {
+         // Read from the PNG headers by dilbert-index, so strips can be laid out before
+         // they are decoded. Size and mtime tell a later scan which files changed.
+         // Keyed by day so searches join it straight from the covering indexes.
+         "CREATE TABLE comic_images ("
+         "day INTEGER PRIMARY KEY, "
+         "width INTEGER NOT NULL, "
+         "height INTEGER NOT NULL, "
+         "file_size INTEGER NOT NULL, "
+         "color_type INTEGER NOT NULL, "
+         "modified INTEGER NOT NULL)",
+     }},
+    {6,
+     {
+         // Search results carry the indexed sizes, so an index run must reach other
+         // instances' caches too. REPLACE deletes without firing triggers, hence no
+         // separate update triggers.
+         "CREATE TRIGGER change_log_image_indexed AFTER INSERT ON comic_images BEGIN "
+         "INSERT INTO change_log(kind, comic_date) VALUES('comic_indexed', date(NEW.day - 0.5)); "
+         "END",
+
+         "CREATE TRIGGER change_log_image_unindexed AFTER DELETE ON comic_images BEGIN "
+         "INSERT INTO change_log(kind, comic_date) VALUES('comic_indexed', date(OLD.day - 0.5)); "
+         "END",
+
+         "CREATE TRIGGER change_log_panels_indexed AFTER INSERT ON comic_panels BEGIN "
+         "INSERT INTO change_log(kind, comic_date) VALUES('comic_indexed', NEW.comic_date); "
+         "END",
+     }},
+};
+
+#undef DAY_KEY
+
+// Every statement the repository runs against its tables is one of these constants,
+// so queryPlanProblems() can check them all. The ones listed in SCANNING_SQL are
+// expected to walk a whole table or index; every other one must seek.
+
+const char* const ALL_TAGS_SQL = "SELECT name FROM tags ORDER BY name ASC";
+
+const char* const HAS_TAG_SQL = "SELECT 1 FROM tags WHERE name = :tag";
+
+const char* const TAGS_FOR_COMIC_SQL =
+    "SELECT tags.name "
+    "FROM tags "
+    "JOIN comic_tags ON comic_tags.tag_id = tags.id "
+    "WHERE comic_tags.comic_date = :date "
+    "ORDER BY tags.name";
+
+// Searches return the indexed strip size too; it is NULL for strips not scanned yet.
+// They are read a page at a time, each page seeking past the last row of the one
+// before (see ComicCursor), so every page is a short statement of its own.
+const char* const COMICS_FOR_TAG_SQL =
+    "SELECT comics.day, comics.image_path, comic_images.width, comic_images.height "
+    "FROM tags "
+    "JOIN comic_tags ON comic_tags.tag_id = tags.id "
+    "JOIN comics ON comics.date = comic_tags.comic_date "
+    "LEFT JOIN comic_images ON comic_images.day = comics.day "
+    "WHERE tags.name = :tag AND comic_tags.comic_date > :after "
+    "ORDER BY comic_tags.comic_date "
+    "LIMIT :limit";
+
+const char* const COMICS_FOR_DATE_SQL =
+    "SELECT comics.day, comics.image_path, comic_images.width, comic_images.height "
+    "FROM comics "
+    "LEFT JOIN comic_images ON comic_images.day = comics.day "
+    "WHERE comics.date = :date AND comics.day > :after "
+    "LIMIT :limit";
+
+// One lower bound, so the index range starts at the page rather than at :from.
+const char* const COMICS_IN_RANGE_SQL =
+    "SELECT comics.day, comics.image_path, comic_images.width, comic_images.height "
+    "FROM comics "
+    "LEFT JOIN comic_images ON comic_images.day = comics.day "
+    "WHERE comics.day > max(:after, :from - 1) AND comics.day <= :to "
+    "ORDER BY comics.day "
+    "LIMIT :limit";
+
+// A substring LIKE cannot use a b-tree index, so this walks every row past :after.
+const char* const COMICS_FOR_TRANSCRIPT_SQL =
+    "SELECT comics.day, comics.image_path, comic_images.width, comic_images.height "
+    "FROM comics "
+    "LEFT JOIN comic_images ON comic_images.day = comics.day "
+    "WHERE comics.day > :after AND comics.transcript LIKE :text "
+    "ORDER BY comics.day "
+    "LIMIT :limit";
+
+const char* const PANELS_FOR_COMIC_SQL = "SELECT rects FROM comic_panels WHERE comic_date = :date";
+
+const char* const TAG_IN_USE_SQL = "SELECT 1 FROM comic_tags WHERE tag_id = :tagId LIMIT 1";
+
+const char* const INDEXED_IMAGE_SQL =
+    "SELECT width, height, file_size, color_type, modified FROM comic_images WHERE day = :day";
+
+const char* const TAG_ID_SQL = "SELECT id FROM tags WHERE name = :name";
+
+const char* const INSERT_TAG_SQL = "INSERT INTO tags(name) VALUES(:name)";
+
+const char* const RENAME_TAG_SQL = "UPDATE tags SET name = :new WHERE name = :old";
+
+const char* const DELETE_TAG_SQL = "DELETE FROM tags WHERE id = :tagId";
+
+// Comics that already carry both tags keep a single link to the new one.
+const char* const MOVE_TAG_LINKS_SQL =
+    "UPDATE OR IGNORE comic_tags SET tag_id = :newId WHERE tag_id = :oldId";
+
+const char* const UNLINK_TAG_SQL = "DELETE FROM comic_tags WHERE tag_id = :tagId";
+
+const char* const LINK_COMIC_TAG_SQL =
+    "INSERT OR IGNORE INTO comic_tags(comic_date, tag_id) VALUES(:date, :tagId)";
+
+const char* const UNLINK_COMIC_TAG_SQL =
+    "DELETE FROM comic_tags WHERE comic_date = :date AND tag_id = :tagId";
+
+const char* const LAST_CHANGE_SQL = "SELECT COALESCE(MAX(seq), 0) FROM change_log";
+
+// A correlated lookup rather than NOT IN, which would scan own_changes into a list.
+const char* const CHANGES_SINCE_SQL =
+    "SELECT seq, kind, comic_date, tag, old_tag "
+    "FROM change_log "
+    "WHERE seq > :seq AND seq <= :upTo "
+    "AND NOT EXISTS (SELECT 1 FROM temp.own_changes WHERE own_changes.seq = change_log.seq) "
+    "ORDER BY seq";
+
+const char* const FORGET_OWN_CHANGES_SQL = "DELETE FROM temp.own_changes WHERE seq <= :upTo";
+
+const char* const PRUNE_CHANGE_LOG_SQL =
+    "DELETE FROM change_log WHERE seq <= (SELECT MAX(seq) FROM change_log) - :keep";
+
+// Only used by the offline indexer, so a scan over comics is fine here.
+const char* const COMICS_WITHOUT_PANELS_SQL =
+    "SELECT comics.day, comics.image_path "
+    "FROM comics "
+    "LEFT JOIN comic_panels ON comic_panels.comic_date = comics.date "
+    "WHERE comic_panels.comic_date IS NULL "
+    "ORDER BY comics.day";
+
+const char* const ALL_COMICS_SQL = "SELECT day, image_path FROM comics ORDER BY day";
+
+const char* const STORE_PANELS_SQL =
+    "INSERT OR REPLACE INTO comic_panels(comic_date, rects) VALUES(:date, :rects)";
+
+const char* const INDEXED_IMAGES_SQL =
+    "SELECT day, width, height, file_size, color_type, modified FROM comic_images";
+
+const char* const STORE_IMAGE_SQL =
+    "INSERT OR REPLACE INTO comic_images(day, width, height, file_size, color_type, modified) "
+    "VALUES(:day, :width, :height, :size, :colorType, :modified)";
+
+const char* const REMOVE_IMAGE_SQL = "DELETE FROM comic_images WHERE day = :day";
+
+// Listings of a whole table, which no index can narrow down.
+const QList<const char*> SCANNING_SQL = {
+    ALL_TAGS_SQL, COMICS_FOR_TRANSCRIPT_SQL, COMICS_WITHOUT_PANELS_SQL, ALL_COMICS_SQL,
+    INDEXED_IMAGES_SQL,
+};
+
+const QList<const char*> KEYED_SQL = {
+    HAS_TAG_SQL,             TAGS_FOR_COMIC_SQL,      COMICS_FOR_TAG_SQL,
+    COMICS_FOR_DATE_SQL,     COMICS_IN_RANGE_SQL,     PANELS_FOR_COMIC_SQL,
+    TAG_IN_USE_SQL,          INDEXED_IMAGE_SQL,       TAG_ID_SQL,
+    INSERT_TAG_SQL,          RENAME_TAG_SQL,          DELETE_TAG_SQL,
+    MOVE_TAG_LINKS_SQL,      UNLINK_TAG_SQL,          LINK_COMIC_TAG_SQL,
+    UNLINK_COMIC_TAG_SQL,    LAST_CHANGE_SQL,         CHANGES_SINCE_SQL,
+    FORGET_OWN_CHANGES_SQL,  PRUNE_CHANGE_LOG_SQL,    STORE_PANELS_SQL,
+    STORE_IMAGE_SQL,         REMOVE_IMAGE_SQL,
+};
+
+QString encodeRects(const QList<QRect>& rects) {
+    QStringList parts;
+    for (const QRect& r : rects)
+        parts << QString("%1,%2,%3,%4").arg(r.x()).arg(r.y()).arg(r.width()).arg(r.height());
+    return parts.join(';');
+}
+
+QList<QRect> decodeRects(const QString& encoded) {
+    QList<QRect> rects;
+    for (const QStringView part : QStringView(encoded).split(';', Qt::SkipEmptyParts)) {
+        const auto v = part.split(',');
+        if (v.size() == 4)
+            rects.append(QRect(v[0].toInt(), v[1].toInt(), v[2].toInt(), v[3].toInt()));
+    }
+    return rects;
+}
+
+// LIKE ignores ASCII case only, so that is all the cache key may fold.
+QString foldAsciiCase(const QString& text) {
+    QString folded = text;
+    for (QChar& c : folded) {
+        if (c >= 'A' && c <= 'Z') c = QChar(c.unicode() + ('a' - 'A'));
+    }
+    return folded;
+}
+
+QList<ComicItem> readComics(QSqlQuery& q) {
+    QList<ComicItem> out;
+
+    while (q.next())
+        out.append({QDate::fromJulianDay(q.value(0).toLongLong()), q.value(1).toString()});
+
+    return out;
+}
+
+}  // namespace
+
+ComicRepository::ComicRepository(const QString& dbPath, OpenMode mode)
+    : connectionName(QString("comics-%1").arg(reinterpret_cast<quintptr>(this))),
+      mode(mode),
+      cache(std::make_shared<ResultCache>(RESULT_CACHE_BYTES)) {
+    QString options = QString("QSQLITE_BUSY_TIMEOUT=%1").arg(BUSY_TIMEOUT_MS);
+    if (mode == ReadOnly) options += ";QSQLITE_OPEN_READONLY";
+
+    db = QSqlDatabase::addDatabase("QSQLITE", connectionName);
+    db.setDatabaseName(dbPath);
+    db.setConnectOptions(options);
+
+    if (!db.open()) {
+        qDebug() << "Failed to open database:" << openError();
+        return;
+    }
+
+    if (mode == ReadWrite) {
+        configureConnection();
+        migrate();
+        pruneChangeLog();
+    }
+
+    trackOwnChanges();
+}
+
+ComicRepository::~ComicRepository() {
+    if (db.isOpen()) {
+        if (mode == ReadWrite) QSqlQuery(db).exec("PRAGMA optimize");
+        db.close();
+    }
+
+    db = QSqlDatabase();
+    QSqlDatabase::removeDatabase(connectionName);
+}
+
+QString ComicRepository::openError() const { return db.lastError().text(); }
+
+void ComicRepository::configureConnection() {
+    QSqlQuery q(db);
+
+    // WAL lets other viewers and the downloader keep reading while one of them writes.
+    if (!q.exec("PRAGMA journal_mode = WAL"))
+        qDebug() << "Failed to enable WAL:" << q.lastError().text();
+
+    q.exec("PRAGMA synchronous = NORMAL");
+}
+
+int ComicRepository::schemaVersion() const {
+    QSqlQuery q("PRAGMA user_version", db);
+    return q.next() ? q.value(0).toInt() : 0;
+}
+
+void ComicRepository::migrate() {
+    if (schemaVersion() >= MIGRATIONS.last().version) return;
+
+    for (const Migration& migration : MIGRATIONS) {
+        QSqlQuery q(db);
+        if (!q.exec("BEGIN IMMEDIATE")) {
+            qDebug() << "Failed to lock database for migration:" << q.lastError().text();
+            return;
+        }
+
+        // Another instance may have migrated while we were waiting for the lock.
+        if (schemaVersion() >= migration.version) {
+            q.exec("COMMIT");
+            continue;
+        }
+
+        for (const QString& statement : migration.statements) {
+            if (!q.exec(statement)) {
+                qDebug() << "Migration" << migration.version << "failed:" << q.lastError().text();
+                q.exec("ROLLBACK");
+                return;
+            }
+        }
+
+        q.exec(QString("PRAGMA user_version = %1").arg(migration.version));
+        if (!q.exec("COMMIT")) {
+            qDebug() << "Failed to commit migration" << migration.version << ":"
+                     << q.lastError().text();
+            q.exec("ROLLBACK");
+            return;
+        }
+    }
+}
+
+void ComicRepository::trackOwnChanges() {
+    QSqlQuery q(db);
+
+    // TEMP triggers only fire for writes made through this connection, so the table
+    // ends up listing exactly the change_log rows this instance wrote itself.
+    if (!q.exec("CREATE TEMP TABLE IF NOT EXISTS own_changes(seq INTEGER PRIMARY KEY)") ||
+        !q.exec("CREATE TEMP TRIGGER IF NOT EXISTS record_own_change "
+                "AFTER INSERT ON main.change_log "
+                "BEGIN INSERT OR IGNORE INTO own_changes VALUES (NEW.seq); END"))
+        qDebug() << "Failed to track own changes:" << q.lastError().text();
+}
+
+void ComicRepository::pruneChangeLog() {
+    QSqlQuery q(db);
+    q.prepare(PRUNE_CHANGE_LOG_SQL);
+    q.bindValue(":keep", CHANGE_LOG_KEEP);
+    q.exec();
+}
+
+QStringList ComicRepository::queryPlanProblems() const {
+    QStringList problems;
+
+    for (const char* sql : SCANNING_SQL + KEYED_SQL) {
+        QSqlQuery q(db);
+        if (!q.exec(QString("EXPLAIN QUERY PLAN ") + sql)) {
+            problems << QString("Cannot explain \"%1\": %2").arg(sql, q.lastError().text());
+            continue;
+        }
+
+        if (SCANNING_SQL.contains(sql)) continue;
+
+        // Keyed statements must SEARCH at every step. Walking a covering index from end
+        // to end is still a scan, so "SCAN ... USING INDEX" counts too.
+        while (q.next()) {
+            const QString detail = q.value(3).toString();
+            if (detail.startsWith("SCAN "))
+                problems << QString("Scan (%1) in \"%2\"").arg(detail, sql);
+        }
+    }
+
+    return problems;
+}
+
+QStringList ComicRepository::allTags() const {
+    QStringList tags;
+    QSqlQuery q(ALL_TAGS_SQL, db);
+
+    while (q.next()) tags << q.value(0).toString();
+
+    return tags;
+}
+
+QStringList ComicRepository::tagsForComic(const QDate& date) const {
+    QStringList tags;
+    QSqlQuery q(db);
+
+    q.prepare(TAGS_FOR_COMIC_SQL);
+    q.bindValue(":date", date.toString(Qt::ISODate));
+    q.exec();
+
+    while (q.next()) tags << q.value(0).toString();
+
+    return tags;
+}
+
+bool ComicRepository::hasTag(const QString& tag) const {
+    QSqlQuery q(db);
+    q.prepare(HAS_TAG_SQL);
+    q.bindValue(":tag", tag);
+
+    return q.exec() && q.next();
+}
+
+ComicCursor ComicRepository::search(const QString& key, ComicCursor::Query query) const {
+    QList<ComicItem> known;
+
+    const CachedResult* cached = cache->results.object(key);
+    if (cached && cached->generation != cache->generation) {
+        cache->results.remove(key);
+        cached = nullptr;
+    }
+
+    if (cached) {
+        ++cache->hits;
+        if (cached->complete) return ComicCursor(cached->comics);
+        known = cached->comics;
+    } else {
+        ++cache->misses;
+    }
+
+    query.connection = connectionName;
+    ComicCursor cursor(std::move(query), known);
+
+    // Whatever part of the result is read gets cached, page by page, so a search that
+    // was only partly scrolled through starts from memory next time too. The cursor
+    // may be read after the repository is gone, so it shares the cache rather than
+    // pointing back at us.
+    cursor.record([cache = cache, key, started = cache->generation](
+                      qsizetype offset, const QList<ComicItem>& page, bool complete) {
+        // A write while the result was being read may have changed it.
+        if (started != cache->generation) return;
+
+        std::unique_ptr<CachedResult> entry(cache->results.take(key));
+        if (!entry || entry->generation != started) {
+            entry.reset(new CachedResult{started, {}, key.size() * qsizetype(sizeof(QChar))});
+        }
+
+        // Only a page that continues the cached rows extends them. Another cursor over
+        // the same search may have got further already, or the rows before this page
+        // may have been evicted.
+        if (entry->comics.size() != offset) {
+            const qsizetype cost = entry->bytes;
+            if (!entry->comics.isEmpty()) cache->results.insert(key, entry.release(), int(cost));
+            return;
+        }
+
+        for (const ComicItem& comic : page) entry->bytes += ComicCursor::rowBytes(comic);
+        entry->comics += page;
+        entry->complete = complete;
+
+        if (entry->bytes > MAX_CACHED_RESULT_BYTES) return;
+
+        const qsizetype cost = entry->bytes;
+        cache->results.insert(key, entry.release(), int(cost));
+    });
+
+    return cursor;
+}
+
+ComicCursor ComicRepository::comicsForTag(const QString& tag) const {
+    const QString name = tag.trimmed();
+
+    return search("tag:" + name,
+                  {{}, COMICS_FOR_TAG_SQL, {{":tag", name}}, ComicCursor::IsoDate});
+}
+
+ComicCursor ComicRepository::comicsForDate(const QString& date) const {
+    const QString day = date.trimmed();
+
+    return search("date:" + day, {{}, COMICS_FOR_DATE_SQL, {{":date", day}}, ComicCursor::Day});
+}
+
+ComicCursor ComicRepository::comicsInRange(const QDate& from, const QDate& to) const {
+    const QString key = QString("range:%1..%2").arg(from.toJulianDay()).arg(to.toJulianDay());
+
+    return search(key,
+                  {{},
+                   COMICS_IN_RANGE_SQL,
+                   {{":from", from.toJulianDay()}, {":to", to.toJulianDay()}},
+                   ComicCursor::Day});
+}
+
+ComicCursor ComicRepository::comicsForTranscript(const QString& text) const {
+    const QString needle = text.trimmed();
+
+    return search("text:" + foldAsciiCase(needle),
+                  {{}, COMICS_FOR_TRANSCRIPT_SQL, {{":text", "%" + needle + "%"}},
+                   ComicCursor::Day});
+}
+
+bool ComicRepository::editTag(const QString& oldTag, const QString& newTag) {
+    if (oldTag == newTag) return true;
+
+    ++cache->generation;
+
+    QSqlQuery q(db);
+    q.prepare(TAG_ID_SQL);
+    q.bindValue(":name", newTag);
+
+    if (!q.exec()) {
+        qDebug() << "Failed to query new tag:" << q.lastError().text();
+        return false;
+    }
+
+    if (q.next()) {
+        int newId = q.value(0).toInt();
+
+        QSqlQuery oldIdQuery(db);
+        oldIdQuery.prepare(TAG_ID_SQL);
+        oldIdQuery.bindValue(":name", oldTag);
+        if (!oldIdQuery.exec() || !oldIdQuery.next()) {
+            qDebug() << "Old tag not found:" << oldTag;
+            return false;
+        }
+        int oldId = oldIdQuery.value(0).toInt();
+
+        QSqlQuery updateQuery(db);
+        updateQuery.prepare(MOVE_TAG_LINKS_SQL);
+        updateQuery.bindValue(":newId", newId);
+        updateQuery.bindValue(":oldId", oldId);
+        if (!updateQuery.exec()) {
+            qDebug() << "Failed to update comic_tags:" << updateQuery.lastError().text();
+            return false;
+        }
+
+        QSqlQuery unlinkQuery(db);
+        unlinkQuery.prepare(UNLINK_TAG_SQL);
+        unlinkQuery.bindValue(":tagId", oldId);
+        if (!unlinkQuery.exec()) {
+            qDebug() << "Failed to unlink old tag:" << unlinkQuery.lastError().text();
+            return false;
+        }
+
+        QSqlQuery deleteQuery(db);
+        deleteQuery.prepare(DELETE_TAG_SQL);
+        deleteQuery.bindValue(":tagId", oldId);
+        if (!deleteQuery.exec()) {
+            qDebug() << "Failed to delete old tag:" << deleteQuery.lastError().text();
+            return false;
+        }
+
+    } else {
+        QSqlQuery updateQuery(db);
+        updateQuery.prepare(RENAME_TAG_SQL);
+        updateQuery.bindValue(":new", newTag);
+        updateQuery.bindValue(":old", oldTag);
+        if (!updateQuery.exec()) {
+            qDebug() << "Failed to update tag name:" << updateQuery.lastError().text();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool ComicRepository::addTagToComic(const QDate& date, const QString& tagName) {
+    ++cache->generation;
+
+    QSqlQuery q(db);
+
+    q.prepare(TAG_ID_SQL);
+    q.bindValue(":name", tagName);
+    if (!q.exec()) return false;
+
+    int tagId;
+    if (q.next()) {
+        tagId = q.value(0).toInt();
+    } else {
+        QSqlQuery insertTag(db);
+        insertTag.prepare(INSERT_TAG_SQL);
+        insertTag.bindValue(":name", tagName);
+        if (!insertTag.exec()) return false;
+        tagId = insertTag.lastInsertId().toInt();
+    }
+
+    QSqlQuery link(db);
+    link.prepare(LINK_COMIC_TAG_SQL);
+    link.bindValue(":date", date.toString(Qt::ISODate));
+    link.bindValue(":tagId", tagId);
+    return link.exec();
+}
+
+bool ComicRepository::removeTagFromComic(const QDate& date, const QString& tagName) {
+    ++cache->generation;
+
+    QSqlQuery q(db);
+    q.prepare(TAG_ID_SQL);
+    q.bindValue(":name", tagName);
+    if (!q.exec()) return false;
+    if (!q.next()) return true;
+
+    int tagId = q.value(0).toInt();
+
+    QSqlQuery del(db);
+    del.prepare(UNLINK_COMIC_TAG_SQL);
+    del.bindValue(":date", date.toString(Qt::ISODate));
+    del.bindValue(":tagId", tagId);
+    if (!del.exec()) return false;
+
+    QSqlQuery check(db);
+    check.prepare(TAG_IN_USE_SQL);
+    check.bindValue(":tagId", tagId);
+    if (!check.exec()) return false;
+    if (!check.next()) {
+        QSqlQuery deleteTag(db);
+        deleteTag.prepare(DELETE_TAG_SQL);
+        deleteTag.bindValue(":tagId", tagId);
+        return deleteTag.exec();
+    }
+
+    return true;
+}
+
+bool ComicRepository::applyTagEdits(const QDate& date, const QList<TagEdit>& edits) {
+    if (edits.isEmpty()) return true;
+
+    // Take the write lock up front so a concurrent writer cannot make the transaction
+    // fail halfway through upgrading from a read lock.
+    QSqlQuery tx(db);
+    if (!tx.exec("BEGIN IMMEDIATE")) {
+        qDebug() << "Failed to begin tag edit transaction:" << tx.lastError().text();
+        return false;
+    }
+
+    for (const TagEdit& edit : edits) {
+        bool ok = false;
+
+        switch (edit.kind) {
+            case TagEdit::Add:
+                ok = addTagToComic(date, edit.tag);
+                break;
+
+            case TagEdit::Remove:
+                ok = removeTagFromComic(date, edit.tag);
+                break;
+
+            case TagEdit::Rename:
+                ok = editTag(edit.tag, edit.newTag);
+                break;
+        }
+
+        if (!ok) {
+            tx.exec("ROLLBACK");
+            return false;
+        }
+    }
+
+    if (!tx.exec("COMMIT")) {
+        qDebug() << "Failed to commit tag edits:" << tx.lastError().text();
+        tx.exec("ROLLBACK");
+        return false;
+    }
+
+    return true;
+}
+
+qint64 ComicRepository::lastChangeSeq() const {
+    QSqlQuery q(LAST_CHANGE_SQL, db);
+    return q.next() ? q.value(0).toLongLong() : 0;
+}
+
+QList<ComicChange> ComicRepository::changesSince(qint64 seq, qint64 upTo) const {
+    QList<ComicChange> out;
+    QSqlQuery q(db);
+
+    q.prepare(CHANGES_SINCE_SQL);
+    q.bindValue(":seq", seq);
+    q.bindValue(":upTo", upTo);
+    q.exec();
+
+    while (q.next())
+        out.append({q.value(0).toLongLong(), changeKind(q.value(1).toString()),
+                    QDate::fromString(q.value(2).toString(), Qt::ISODate), q.value(3).toString(),
+                    q.value(4).toString()});
+
+    // Those rows have now been skipped once and will not be asked for again.
+    QSqlQuery prune(db);
+    prune.prepare(FORGET_OWN_CHANGES_SQL);
+    prune.bindValue(":upTo", upTo);
+    prune.exec();
+
+    return out;
+}
+
+std::optional<QList<QRect>> ComicRepository::panelsForComic(const QDate& date) const {
+    QSqlQuery q(db);
+    q.prepare(PANELS_FOR_COMIC_SQL);
+    q.bindValue(":date", date.toString(Qt::ISODate));
+
+    if (!q.exec() || !q.next()) return std::nullopt;
+    return decodeRects(q.value(0).toString());
+}
+
+QList<ComicItem> ComicRepository::comicsWithoutPanels() const {
+    QSqlQuery q(db);
+    q.setForwardOnly(true);
+    q.exec(COMICS_WITHOUT_PANELS_SQL);
+
+    return readComics(q);
+}
+
+QList<ComicItem> ComicRepository::allComics() const {
+    QSqlQuery q(db);
+    q.setForwardOnly(true);
+    q.exec(ALL_COMICS_SQL);
+
+    return readComics(q);
+}
+
+bool ComicRepository::storePanels(const QList<ComicPanels>& results) {
+    if (results.isEmpty()) return true;
+
+    QSqlQuery tx(db);
+    if (!tx.exec("BEGIN IMMEDIATE")) {
+        qDebug() << "Failed to begin panel transaction:" << tx.lastError().text();
+        return false;
+    }
+
+    QSqlQuery q(db);
+    q.prepare(STORE_PANELS_SQL);
+
+    for (const ComicPanels& result : results) {
+        q.bindValue(":date", result.date.toString(Qt::ISODate));
+        q.bindValue(":rects", encodeRects(result.panels));
+        if (!q.exec()) {
+            qDebug() << "Failed to store panels:" << q.lastError().text();
+            tx.exec("ROLLBACK");
+            return false;
+        }
+    }
+
+    if (!tx.exec("COMMIT")) {
+        qDebug() << "Failed to commit panels:" << tx.lastError().text();
+        tx.exec("ROLLBACK");
+        return false;
+    }
+
+    return true;
+}
+
+std::optional<ComicImage> ComicRepository::indexedImage(const QDate& date) const {
+    QSqlQuery q(db);
+    q.prepare(INDEXED_IMAGE_SQL);
+    q.bindValue(":day", date.toJulianDay());
+
+    if (!q.exec() || !q.next()) return std::nullopt;
+    return ComicImage{date, QSize(q.value(0).toInt(), q.value(1).toInt()),
+                      q.value(2).toLongLong(), q.value(3).toInt(), q.value(4).toLongLong()};
+}
+
+QHash<QDate, ComicImage> ComicRepository::indexedImages() const {
+    QHash<QDate, ComicImage> images;
+
+    QSqlQuery q(db);
+    q.setForwardOnly(true);
+    q.exec(INDEXED_IMAGES_SQL);
+
+    while (q.next()) {
+        const QDate date = QDate::fromJulianDay(q.value(0).toLongLong());
+        images.insert(date, {date, QSize(q.value(1).toInt(), q.value(2).toInt()),
+                             q.value(3).toLongLong(), q.value(4).toInt(), q.value(5).toLongLong()});
+    }
+
+    return images;
+}
+
+bool ComicRepository::storeImages(const QList<ComicImage>& images, const QList<QDate>& removed) {
+    if (images.isEmpty() && removed.isEmpty()) return true;
+
+    // Cached search results carry the sizes.
+    ++cache->generation;
+
+    QSqlQuery tx(db);
+    if (!tx.exec("BEGIN IMMEDIATE")) {
+        qDebug() << "Failed to begin image index transaction:" << tx.lastError().text();
+        return false;
+    }
+
+    QSqlQuery q(db);
+    q.prepare(STORE_IMAGE_SQL);
+
+    QSqlQuery del(db);
+    del.prepare(REMOVE_IMAGE_SQL);
+
+    for (const ComicImage& image : images) {
+        q.bindValue(":day", image.date.toJulianDay());
+        q.bindValue(":width", image.size.width());
+        q.bindValue(":height", image.size.height());
+        q.bindValue(":size", image.fileSize);
+        q.bindValue(":colorType", image.colorType);
+        q.bindValue(":modified", image.modified);
+        if (!q.exec()) {
+            qDebug() << "Failed to store image index:" << q.lastError().text();
+            tx.exec("ROLLBACK");
+            return false;
+        }
+    }
+
+    for (const QDate& date : removed) {
+        del.bindValue(":day", date.toJulianDay());
+        if (!del.exec()) {
+            qDebug() << "Failed to remove from image index:" << del.lastError().text();
+            tx.exec("ROLLBACK");
+            return false;
+        }
+    }
+
+    if (!tx.exec("COMMIT")) {
+        qDebug() << "Failed to commit image index:" << tx.lastError().text();
+        tx.exec("ROLLBACK");
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,128 @@
+#pragma once
+#include <QCache>
+#include <QHash>
+#include <QRect>
+#include <QSqlDatabase>
+#include <QStringList>
+#include <memory>
+#include <optional>
+
+#include "ComicChange.h"
+#include "ComicCursor.h"
+#include "ComicItem.h"
+#include "TagEditJournal.h"
+
+struct ComicPanels {
+    QDate date;
+    QList<QRect> panels;
+};
+
+struct ComicImage {
+    QDate date;
+    QSize size;
+    qint64 fileSize = 0;
+    int colorType = 0;  // as in the PNG header
+    qint64 modified = 0;  // msecs since epoch
+};
+
+class ComicRepository {
+public:
+    // ReadOnly never creates, migrates or prunes the database, for tools that only
+    // look things up; the file must already exist at the current schema.
+    enum OpenMode { ReadWrite, ReadOnly };
+
+    explicit ComicRepository(const QString& dbPath, OpenMode mode = ReadWrite);
+    ~ComicRepository();
+
+    // False when the database could not be opened; openError() says why. Nothing
+    // else may be called then.
+    bool isOpen() const { return db.isOpen(); }
+    QString openError() const;
+
+    QString databasePath() const { return db.databaseName(); }
+
+    QStringList allTags() const;
+    QStringList tagsForComic(const QDate& date) const;
+    bool hasTag(const QString& tag) const;
+
+    // Searches are read a page at a time; see ComicCursor. The rows a search has read
+    // so far stay in memory until the next write: repeating it replays them and only
+    // goes to the database for the rows after them, if the first reader stopped short.
+    ComicCursor comicsForTag(const QString& tag) const;
+    ComicCursor comicsForDate(const QString& date) const;
+    ComicCursor comicsInRange(const QDate& from, const QDate& to) const;
+    ComicCursor comicsForTranscript(const QString& text) const;
+    QList<ComicItem> allComics() const;
+
+    // Nothing when the strip has not been analysed yet; an empty list when it has but
+    // does not split into panels.
+    std::optional<QList<QRect>> panelsForComic(const QDate& date) const;
+    QList<ComicItem> comicsWithoutPanels() const;
+    bool storePanels(const QList<ComicPanels>& results);
+
+    // A strip's entry in the image index, so it can be laid out without decoding;
+    // nothing if it has not been scanned yet.
+    std::optional<ComicImage> indexedImage(const QDate& date) const;
+    QHash<QDate, ComicImage> indexedImages() const;
+    bool storeImages(const QList<ComicImage>& images, const QList<QDate>& removed);
+
+    bool removeTagFromComic(const QDate& date, const QString& tagName);
+    bool addTagToComic(const QDate& date, const QString& tagName);
+
+    bool editTag(const QString& oldTag, const QString& newTag);
+
+    // Applies all edits in a single transaction; nothing is written if any edit fails.
+    bool applyTagEdits(const QDate& date, const QList<TagEdit>& edits);
+
+    qint64 lastChangeSeq() const;
+    // Changes in (seq, upTo], leaving out the ones this instance made itself; the
+    // caller has already applied those.
+    QList<ComicChange> changesSince(qint64 seq, qint64 upTo) const;
+
+    // Drops cached search results; for writes made by other processes, which only
+    // show up in the change feed.
+    void invalidateResults() { ++cache->generation; }
+
+    qint64 cacheHits() const { return cache->hits; }
+    qint64 cacheMisses() const { return cache->misses; }
+
+    int schemaVersion() const;
+
+    // Describes every statement that SQLite would answer with a scan where a seek was
+    // expected. Only the listings of a whole table and the transcript search, which
+    // substring matches keep from using an index, may scan.
+    QStringList queryPlanProblems() const;
+
+private:
+    void configureConnection();
+    void migrate();
+    void trackOwnChanges();
+    void pruneChangeLog();
+
+    // The rows of a search read so far, in order; `complete` once they are all of it.
+    struct CachedResult {
+        quint64 generation;
+        QList<ComicItem> comics;
+        qsizetype bytes;
+        bool complete = false;
+    };
+
+    // Shared with the cursors that fill it, so none of them points back at the
+    // repository. `generation` is bumped by every write; a cached result is only
+    // valid for the generation it was read in.
+    struct ResultCache {
+        explicit ResultCache(int maxCost) : results(maxCost) {}
+
+        quint64 generation = 0;
+        QCache<QString, CachedResult> results;
+        qint64 hits = 0;
+        qint64 misses = 0;
+    };
+
+    ComicCursor search(const QString& key, ComicCursor::Query query) const;
+
+    QString connectionName;
+    QSqlDatabase db;
+    OpenMode mode;
+    std::shared_ptr<ResultCache> cache;
+};
@@ -0,0 +1,142 @@
+#include "PanelDetector.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+// Anything darker than this is ink: panel borders, lettering, artwork.
+constexpr int INK_THRESHOLD = 160;
+
+// A row or column still counts as gutter with this much stray ink (1 in 200 pixels),
+// so specks and antialiasing from the scan do not break it up.
+constexpr int NOISE_DIVISOR = 200;
+
+// Gutters narrower than 1/200 of the strip are gaps inside artwork, not between panels.
+constexpr int MIN_GUTTER_DIVISOR = 200;
+
+// Tiers and panels smaller than this fraction of the strip are captions or credits.
+constexpr int MIN_TIER_DIVISOR = 8;
+constexpr int MIN_PANEL_DIVISOR = 10;
+
+using Span = std::pair<int, int>;  // [first, last)
+
+int inkInRow(const uint8_t* p, int n) {
+    int count = 0;
+    int x = 0;
+
+#if defined(__SSE2__)
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i limit = _mm_set1_epi8(char(INK_THRESHOLD - 1));
+
+    while (x + 16 <= n) {
+        __m128i acc = zero;
+
+        // Per-byte counters would overflow after 255 steps, so fold them into the
+        // total once per block.
+        for (int step = 0; step < 255 && x + 16 <= n; ++step, x += 16) {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + x));
+            const __m128i ink = _mm_cmpeq_epi8(_mm_min_epu8(v, limit), v);
+            acc = _mm_sub_epi8(acc, ink);
+        }
+
+        const __m128i sums = _mm_sad_epu8(acc, zero);
+        count += _mm_cvtsi128_si32(sums) + _mm_cvtsi128_si32(_mm_srli_si128(sums, 8));
+    }
+#endif
+
+    for (; x < n; ++x) count += p[x] < INK_THRESHOLD;
+    return count;
+}
+
+void addInkPerColumn(uint16_t* counts, const uint8_t* p, int n) {
+    int x = 0;
+
+#if defined(__SSE2__)
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i one = _mm_set1_epi8(1);
+    const __m128i limit = _mm_set1_epi8(char(INK_THRESHOLD - 1));
+
+    for (; x + 16 <= n; x += 16) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + x));
+        const __m128i ink = _mm_and_si128(_mm_cmpeq_epi8(_mm_min_epu8(v, limit), v), one);
+
+        auto* lo = reinterpret_cast<__m128i*>(counts + x);
+        auto* hi = reinterpret_cast<__m128i*>(counts + x + 8);
+        _mm_storeu_si128(lo, _mm_add_epi16(_mm_loadu_si128(lo), _mm_unpacklo_epi8(ink, zero)));
+        _mm_storeu_si128(hi, _mm_add_epi16(_mm_loadu_si128(hi), _mm_unpackhi_epi8(ink, zero)));
+    }
+#endif
+
+    for (; x < n; ++x) counts[x] += p[x] < INK_THRESHOLD;
+}
+
+// Splits [0, blank.size()) into runs of content separated by gutters of at least
+// minGutter blank entries, dropping runs shorter than minLength.
+std::vector<Span> contentRuns(const std::vector<bool>& blank, int minGutter, int minLength) {
+    std::vector<Span> runs;
+    const int n = int(blank.size());
+
+    int first = -1;
+    int gap = 0;
+    for (int i = 0; i <= n; ++i) {
+        if (i < n && !blank[i]) {
+            if (first < 0) first = i;
+            gap = 0;
+            continue;
+        }
+
+        if (first < 0) continue;
+        if (i < n && ++gap < minGutter) continue;
+
+        const int last = i - (i < n ? gap - 1 : gap);
+        if (last - first >= minLength) runs.emplace_back(first, last);
+        first = -1;
+        gap = 0;
+    }
+
+    return runs;
+}
+
+}  // namespace
+
+QList<QRect> PanelDetector::detect(const uchar* pixels, int width, int height,
+                                   qsizetype bytesPerLine) {
+    if (width <= 0 || height <= 0) return {};
+
+    const auto row = [pixels, bytesPerLine](int y) { return pixels + y * bytesPerLine; };
+
+    std::vector<bool> blankRows(height);
+    for (int y = 0; y < height; ++y)
+        blankRows[y] = inkInRow(row(y), width) <= width / NOISE_DIVISOR;
+
+    const std::vector<Span> tiers = contentRuns(
+        blankRows, std::max(2, height / MIN_GUTTER_DIVISOR), height / MIN_TIER_DIVISOR);
+
+    QList<QRect> panels;
+    std::vector<uint16_t> inkColumns(width);
+    std::vector<bool> blankColumns(width);
+
+    for (const auto& [top, bottom] : tiers) {
+        std::fill(inkColumns.begin(), inkColumns.end(), 0);
+        for (int y = top; y < bottom; ++y) addInkPerColumn(inkColumns.data(), row(y), width);
+
+        const int tolerance = (bottom - top) / NOISE_DIVISOR;
+        for (int x = 0; x < width; ++x) blankColumns[x] = inkColumns[x] <= tolerance;
+
+        const std::vector<Span> columns = contentRuns(
+            blankColumns, std::max(2, width / MIN_GUTTER_DIVISOR), width / MIN_PANEL_DIVISOR);
+
+        for (const auto& [left, right] : columns)
+            panels.append(QRect(left, top, right - left, bottom - top));
+    }
+
+    if (panels.size() < 2) return {};
+    return panels;
+}
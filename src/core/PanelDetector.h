@@ -0,0 +1,16 @@
+#pragma once
+#include <QList>
+#include <QRect>
+#include <QtGlobal>
+
+// Finds the panels of a strip by looking for white gutters: first full-width runs of
+// blank rows split the strip into tiers, then blank columns within each tier split
+// the tiers into panels. Works on 8-bit grayscale pixels so it needs no image
+// library; the row and column scans are vectorised.
+namespace PanelDetector {
+
+// Returns the panels in reading order, or an empty list when the strip does not
+// split into at least two panels.
+QList<QRect> detect(const uchar* pixels, int width, int height, qsizetype bytesPerLine);
+
+}  // namespace PanelDetector
@@ -0,0 +1,38 @@
+#include "PngHeader.h"
+
+#include <QFile>
+#include <climits>
+#include <cstring>
+
+namespace {
+
+// Signature, then the IHDR chunk: length, type, width, height, bit depth, colour type.
+constexpr int HEADER_BYTES = 8 + 4 + 4 + 4 + 4 + 1 + 1;
+constexpr unsigned char SIGNATURE[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+
+quint32 bigEndian32(const unsigned char* p) {
+    return quint32(p[0]) << 24 | quint32(p[1]) << 16 | quint32(p[2]) << 8 | quint32(p[3]);
+}
+
+}  // namespace
+
+std::optional<PngHeader::Info> PngHeader::read(const QString& path) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) return std::nullopt;
+
+    unsigned char header[HEADER_BYTES];
+    if (file.read(reinterpret_cast<char*>(header), HEADER_BYTES) != HEADER_BYTES)
+        return std::nullopt;
+
+    if (std::memcmp(header, SIGNATURE, sizeof(SIGNATURE)) != 0) return std::nullopt;
+    if (bigEndian32(header + 8) != 13 || std::memcmp(header + 12, "IHDR", 4) != 0)
+        return std::nullopt;
+
+    const quint32 width = bigEndian32(header + 16);
+    const quint32 height = bigEndian32(header + 20);
+
+    // The format caps both at 2^31 - 1; zero is invalid.
+    if (width == 0 || height == 0 || width > INT_MAX || height > INT_MAX) return std::nullopt;
+
+    return Info{QSize(int(width), int(height)), header[24], header[25]};
+}
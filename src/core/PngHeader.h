@@ -0,0 +1,19 @@
+#pragma once
+#include <QSize>
+#include <QString>
+#include <optional>
+
+// Reads a strip's dimensions from the IHDR chunk at the start of a PNG, which the
+// format requires to come first; only the first 26 bytes are read, nothing is decoded.
+namespace PngHeader {
+
+struct Info {
+    QSize size;
+    int bitDepth;
+    int colorType;  // 0 gray, 2 RGB, 3 palette, 4 gray + alpha, 6 RGBA
+};
+
+// Returns nothing for files that are missing, truncated or not PNGs.
+std::optional<Info> read(const QString& path);
+
+}  // namespace PngHeader
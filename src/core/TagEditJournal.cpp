@@ -0,0 +1,65 @@
+#include "TagEditJournal.h"
+
+#include <algorithm>
+
+TagEditJournal::TagEditJournal(const QDate& date, const QStringList& baseTags)
+    : comicDate(date), base(baseTags), current(baseTags) {}
+
+bool TagEditJournal::add(const QString& tag) { return record({TagEdit::Add, tag, {}}); }
+
+bool TagEditJournal::remove(const QString& tag) { return record({TagEdit::Remove, tag, {}}); }
+
+bool TagEditJournal::rename(const QString& oldTag, const QString& newTag) {
+    return record({TagEdit::Rename, oldTag, newTag});
+}
+
+void TagEditJournal::undo() {
+    if (!canUndo()) return;
+
+    --position;
+    rebuild();
+}
+
+void TagEditJournal::redo() {
+    if (!canRedo()) return;
+
+    apply(current, journal[position]);
+    ++position;
+}
+
+bool TagEditJournal::record(const TagEdit& edit) {
+    // Edits that would not change the tag list are never journaled, so every entry
+    // corresponds to a visible step for undo and a real write on commit.
+    if (!apply(current, edit)) return false;
+
+    journal.resize(position);
+    journal.append(edit);
+    ++position;
+    return true;
+}
+
+void TagEditJournal::rebuild() {
+    current = base;
+    for (qsizetype i = 0; i < position; ++i) apply(current, journal[i]);
+}
+
+bool TagEditJournal::apply(QStringList& tags, const TagEdit& edit) {
+    switch (edit.kind) {
+        case TagEdit::Add:
+            if (edit.tag.isEmpty() || tags.contains(edit.tag)) return false;
+            tags.insert(std::lower_bound(tags.begin(), tags.end(), edit.tag), edit.tag);
+            return true;
+
+        case TagEdit::Remove:
+            return tags.removeOne(edit.tag);
+
+        case TagEdit::Rename:
+            if (edit.newTag.isEmpty() || edit.tag == edit.newTag) return false;
+            if (!tags.removeOne(edit.tag)) return false;
+            if (!tags.contains(edit.newTag))
+                tags.insert(std::lower_bound(tags.begin(), tags.end(), edit.newTag), edit.newTag);
+            return true;
+    }
+
+    return false;
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include <QDate>
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+struct TagEdit {
+    enum Kind { Add, Remove, Rename };
+
+    Kind kind;
+    QString tag;
+    QString newTag;
+};
+
+// In-memory record of staged tag edits for a single comic. Edits are applied to the
+// base tag list on the fly so the UI can show them before anything is written, and
+// can be undone or redone until the journal is committed to the repository.
+class TagEditJournal {
+public:
+    TagEditJournal() = default;
+    TagEditJournal(const QDate& date, const QStringList& baseTags);
+
+    const QDate& date() const { return comicDate; }
+    QStringList tags() const { return current; }
+
+    // Only the edits up to the undo position; undone edits are not committed.
+    QList<TagEdit> edits() const { return journal.mid(0, position); }
+    bool isEmpty() const { return position == 0; }
+
+    bool add(const QString& tag);
+    bool remove(const QString& tag);
+    bool rename(const QString& oldTag, const QString& newTag);
+
+    bool canUndo() const { return position > 0; }
+    bool canRedo() const { return position < journal.size(); }
+    void undo();
+    void redo();
+
+private:
+    bool record(const TagEdit& edit);
+    void rebuild();
+    static bool apply(QStringList& tags, const TagEdit& edit);
+
+    QDate comicDate;
+    QStringList base;
+    QStringList current;
+    QList<TagEdit> journal;
+    qsizetype position = 0;
+};
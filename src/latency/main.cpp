@@ -0,0 +1,585 @@
+// dilbert-latency: end-to-end UI latency check. Generates a throwaway library, runs
+// the real DilbertViewer on the offscreen platform and scripts navigation, search,
+// gallery and tag events against its own controls, timing each from the input to the
+// paint that shows its result.
+//
+//   dilbert-latency [--events N] [--seed N] [--budget SCENARIO=MS]...
+//
+// Prints p50/p95/p99 latencies and dropped frames per scenario and exits with 1 when
+// a p95 is over its budget or an event never produced a paint. ctest runs it with a
+// few hundred events against the same budgets.
+
+#include <QApplication>
+#include <QComboBox>
+#include <QDateTime>
+#include <QDialog>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QKeyEvent>
+#include <QLineEdit>
+#include <QListWidget>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QRandomGenerator>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QTemporaryDir>
+#include <QTimer>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+
+#include "ComicLibrary.h"
+#include "ComicRepository.h"
+#include "ComicSearchWidget.h"
+#include "ComicTagsEditorDialog.h"
+#include "ComicTagsWidget.h"
+#include "ComicViewerWidget.h"
+#include "DilbertViewer.h"
+
+namespace {
+
+const QDate FIRST_DAY{1989, 4, 16};
+const QDate LAST_DAY{2023, 3, 12};
+const QDate NAVIGATION_START{2006, 1, 1};
+
+constexpr double FRAME_MS = 1000.0 / 60;
+constexpr qint64 TIMEOUT_MS = 2000;
+
+const QStringList TAGS = {
+    "Alice", "Asok", "Boss", "Carol", "Catbert", "Dilbert", "Dogbert", "Loud Howard", "Ratbert",
+    "Tina", "Wally", "budget", "coffee", "consultants", "engineering", "marketing", "meetings",
+    "reorg", "sales", "technology",
+};
+
+const QStringList WORDS = {
+    "project", "deadline", "synergy", "coffee", "budget", "meeting", "cubicle", "memo",
+    "strategy", "customer", "server", "layoffs", "raise", "vacation", "prototype", "bug",
+};
+
+struct Scenario {
+    const char* name;
+    double budgetMs;
+    QList<double> latencies;
+    int timeouts = 0;
+    qint64 droppedFrames = 0;
+};
+
+// Records whether a widget, or any of its children, painted while ready() held.
+// The paint itself finishes before processEvents() returns, so polling the flag
+// after each pass of the event loop measures up to the finished frame.
+//
+// Until then it also times the gaps between paints anywhere in the window. A gap of
+// more than a frame, once the window has started updating, is a frame it dropped.
+class PaintProbe : public QObject {
+public:
+    void arm(QWidget* widget, std::function<bool()> condition) {
+        target = widget;
+        ready = std::move(condition);
+        seen = false;
+        lastPaintNs = -1;
+        dropped = 0;
+        clock.start();
+    }
+
+    bool painted() const { return seen; }
+    int droppedFrames() const { return dropped; }
+
+protected:
+    bool eventFilter(QObject* watched, QEvent* event) override {
+        if (event->type() != QEvent::Paint || seen || !target) return false;
+
+        auto* widget = qobject_cast<QWidget*>(watched);
+        if (!widget || widget->window() != target->window()) return false;
+
+        const qint64 now = clock.nsecsElapsed();
+        if (lastPaintNs >= 0 && (now - lastPaintNs) / 1e6 > FRAME_MS) ++dropped;
+        lastPaintNs = now;
+
+        if ((widget == target || target->isAncestorOf(widget)) && (!ready || ready()))
+            seen = true;
+
+        return false;
+    }
+
+private:
+    QWidget* target = nullptr;
+    std::function<bool()> ready;
+    bool seen = false;
+
+    QElapsedTimer clock;
+    qint64 lastPaintNs = -1;
+    int dropped = 0;
+};
+
+struct Layout {
+    QString file;
+    QList<QRect> panels;
+    ComicImage image;  // header index entry, minus the date
+};
+
+// Panel borders on white with some stand-in artwork, so the strips decode and scale
+// like real ones and the panel detector would find the same rectangles.
+Layout renderStrip(const QString& file, const QSize& size, int tiers, int columns,
+                   QRandomGenerator& rng) {
+    constexpr int MARGIN = 10;
+    constexpr int GUTTER = 14;
+
+    QImage strip(size, QImage::Format_RGB32);
+    strip.fill(Qt::white);
+
+    const int w = (size.width() - 2 * MARGIN - (columns - 1) * GUTTER) / columns;
+    const int h = (size.height() - 2 * MARGIN - (tiers - 1) * GUTTER) / tiers;
+
+    Layout layout{file, {}, {}};
+    QPainter painter(&strip);
+    painter.setRenderHint(QPainter::Antialiasing);
+
+    for (int tier = 0; tier < tiers; ++tier) {
+        for (int column = 0; column < columns; ++column) {
+            const QRect panel(MARGIN + column * (w + GUTTER), MARGIN + tier * (h + GUTTER), w, h);
+            layout.panels.append(panel);
+
+            for (int i = 0; i < 12; ++i) {
+                const int shade = rng.bounded(40, 200);
+                painter.setPen(QPen(QColor(shade, shade, shade), rng.bounded(1, 4)));
+                painter.drawEllipse(QRect(panel.x() + rng.bounded(w - 40),
+                                          panel.y() + rng.bounded(h - 40), rng.bounded(10, 40),
+                                          rng.bounded(10, 40)));
+                painter.drawLine(panel.x() + rng.bounded(w), panel.y() + rng.bounded(h),
+                                 panel.x() + rng.bounded(w), panel.y() + rng.bounded(h));
+            }
+
+            painter.setPen(QPen(Qt::black, 3));
+            painter.drawRect(panel);
+        }
+    }
+
+    painter.end();
+    strip.save(file);
+
+    const QFileInfo info(file);
+    layout.image = {{}, size, info.size(), 2, info.lastModified().toMSecsSinceEpoch()};
+    return layout;
+}
+
+// Strips are drawn once per layout and linked into place for every day, so a full
+// library takes seconds to generate and little disk space.
+bool generateLibrary(const ComicLibrary& library, QRandomGenerator& rng) {
+    const QString strips = library.root() + "/.strips";
+    QDir().mkpath(strips);
+
+    QList<Layout> dailies;
+    QList<Layout> sundays;
+    for (int i = 0; i < 4; ++i)
+        dailies.append(renderStrip(QString("%1/daily-%2.png").arg(strips).arg(i), {900, 280}, 1,
+                                   3, rng));
+    for (int i = 0; i < 2; ++i)
+        sundays.append(renderStrip(QString("%1/sunday-%2.png").arg(strips).arg(i), {900, 630},
+                                   2, 3, rng));
+
+    // Creates the schema before the rows go in through a plain connection.
+    ComicRepository repo(library.databasePath());
+    if (!repo.isOpen()) return false;
+
+    const QString connection = "latency-seed";
+    QList<ComicPanels> panels;
+    QList<ComicImage> images;
+    bool ok = false;
+
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", connection);
+        db.setDatabaseName(library.databasePath());
+        ok = db.open() && db.transaction();
+
+        QSqlQuery tag(db);
+        tag.prepare("INSERT INTO tags(id, name) VALUES(?, ?)");
+        for (qsizetype i = 0; ok && i < TAGS.size(); ++i) {
+            tag.bindValue(0, int(i + 1));
+            tag.bindValue(1, TAGS[i]);
+            ok = tag.exec();
+        }
+
+        QSqlQuery comic(db);
+        comic.prepare("INSERT INTO comics(date, image_path, transcript) VALUES(?, ?, ?)");
+        QSqlQuery link(db);
+        link.prepare("INSERT OR IGNORE INTO comic_tags(comic_date, tag_id) VALUES(?, ?)");
+
+        for (QDate day = FIRST_DAY; ok && day <= LAST_DAY; day = day.addDays(1)) {
+            const QList<Layout>& layouts = day.dayOfWeek() == Qt::Sunday ? sundays : dailies;
+            const Layout& layout = layouts[rng.bounded(int(layouts.size()))];
+
+            const QString path = library.comicPath(day);
+            QDir().mkpath(QFileInfo(path).path());
+            if (!QFile::link(QFileInfo(layout.file).absoluteFilePath(), path)) ok = false;
+
+            QStringList transcript;
+            for (int i = 0; i < 8; ++i) transcript << WORDS[rng.bounded(int(WORDS.size()))];
+
+            const QString date = day.toString(Qt::ISODate);
+            comic.bindValue(0, date);
+            comic.bindValue(1, path.mid(library.root().size() + 1));
+            comic.bindValue(2, transcript.join(' '));
+            ok = ok && comic.exec();
+
+            for (int i = rng.bounded(1, 4); ok && i > 0; --i) {
+                link.bindValue(0, date);
+                link.bindValue(1, rng.bounded(1, int(TAGS.size()) + 1));
+                ok = link.exec();
+            }
+
+            panels.append({day, layout.panels});
+            images.append(layout.image);
+            images.last().date = day;
+        }
+
+        ok = ok && db.commit();
+    }
+
+    QSqlDatabase::removeDatabase(connection);
+    return ok && repo.storePanels(panels) && repo.storeImages(images, {});
+}
+
+double percentile(const QList<double>& sorted, double p) {
+    if (sorted.isEmpty()) return 0;
+
+    const qsizetype rank = qsizetype(std::ceil(p * sorted.size()));
+    return sorted[std::clamp<qsizetype>(rank - 1, 0, sorted.size() - 1)];
+}
+
+class Harness {
+public:
+    Harness(DilbertViewer& window, quint32 seed)
+        : window(window),
+          rng(seed),
+          viewer(window.findChild<ComicViewerWidget*>()),
+          search(window.findChild<ComicSearchWidget*>()),
+          tags(window.findChild<ComicTagsWidget*>()),
+          modeBox(search->findChild<QComboBox*>()),
+          edit(search->findChild<QLineEdit*>()),
+          gallery(search->findChild<QListWidget*>()) {
+        qApp->installEventFilter(&probe);
+    }
+
+    // Key presses sent to the main window: mostly paging forward, as a reader would.
+    // Strips decode in the background, so only a paint of the decoded strip counts.
+    void navigate(Scenario& scenario, int events) {
+        select(NAVIGATION_START);
+
+        for (int i = 0; i < events; ++i) {
+            const int roll = rng.bounded(100);
+            const Qt::Key key = roll < 70   ? Qt::Key_N
+                                : roll < 90 ? Qt::Key_P
+                                : roll < 95 ? Qt::Key_V
+                                            : Qt::Key_R;
+
+            const auto press = [&] {
+                QKeyEvent event(QEvent::KeyPress, key, Qt::NoModifier);
+                QApplication::sendEvent(&window, &event);
+            };
+
+            record(scenario, measure(viewer, press, [&] { return !viewer->isLoading(); }));
+        }
+    }
+
+    // Enter in the search box until the first thumbnail is on screen.
+    void searchResults(Scenario& scenario, int events) {
+        for (int i = 0; i < events; ++i) {
+            const auto mode = static_cast<ComicSearchWidget::Mode>(rng.bounded(3));
+
+            QString query;
+            switch (mode) {
+                case ComicSearchWidget::Tag:
+                    query = TAGS[rng.bounded(int(TAGS.size()))];
+                    break;
+
+                case ComicSearchWidget::Date:
+                    query = randomDay().toString(Qt::ISODate);
+                    break;
+
+                case ComicSearchWidget::Transcript:
+                    query = WORDS[rng.bounded(int(WORDS.size()))];
+                    break;
+            }
+
+            modeBox->setCurrentIndex(mode);
+            edit->setText(query);
+
+            const auto enter = [&] {
+                QKeyEvent event(QEvent::KeyPress, Qt::Key_Return, Qt::NoModifier);
+                QApplication::sendEvent(edit, &event);
+            };
+
+            record(scenario, measure(gallery, enter, [&] { return thumbnailShown(); }));
+        }
+    }
+
+    // A click on a search result in the gallery until the viewer shows the strip.
+    void openResults(Scenario& scenario, int events) {
+        for (int i = 0; i < events; ++i) record(scenario, openResult(randomDay()));
+    }
+
+    // A click on one of the comic's tag chips until the first thumbnail is shown.
+    void tagClicks(Scenario& scenario, int events) {
+        for (int i = 0; i < events; ++i) {
+            select(randomDay());
+
+            QList<QPushButton*> chips;
+            for (QPushButton* chip : tags->findChildren<QPushButton*>()) {
+                if (!chip->isHidden()) chips.append(chip);
+            }
+            if (chips.isEmpty()) continue;
+
+            QPushButton* chip = chips[rng.bounded(int(chips.size()))];
+            const auto click = [chip] { chip->click(); };
+            record(scenario, measure(gallery, click, [&] { return thumbnailShown(); }));
+        }
+    }
+
+    // A tag staged through the editor's controls until the chips show it; the Close
+    // button then commits it. Each tag added is removed again.
+    void tagEdits(Scenario& scenario, int events) {
+        for (int i = 0; i < events; i += 2) {
+            const QDate day = randomDay();
+            select(day);
+
+            const QString tag = QString("bench-%1").arg(i);
+            for (const bool adding : {true, false}) {
+                TagEditJournal journal(day, tags->currentTags());
+                if (adding ? !journal.add(tag) : !journal.remove(tag)) continue;
+
+                tags->openEditDialog();
+                auto* editor = tags->findChild<ComicTagsEditorDialog*>();
+                QCoreApplication::processEvents();
+
+                const QStringList expected = journal.tags();
+                const auto shown = [&] { return tags->currentTags() == expected; };
+                record(scenario, adding ? addThroughPrompt(editor, tag, shown)
+                                        : removeRow(editor, tag, shown));
+
+                button(editor, "Close")->click();
+                QCoreApplication::processEvents();
+            }
+        }
+    }
+
+private:
+    // Placeholders go up first; only a decoded thumbnail counts as a result.
+    bool thumbnailShown() const { return search->thumbnailsShown() > 0; }
+
+    QDate randomDay() { return FIRST_DAY.addDays(rng.bounded(FIRST_DAY.daysTo(LAST_DAY) + 1)); }
+
+    static QPushButton* button(QWidget* parent, const QString& text) {
+        for (QPushButton* button : parent->findChildren<QPushButton*>()) {
+            if (button->text() == text) return button;
+        }
+        return nullptr;
+    }
+
+    // Looks `day` up by date, then clicks its thumbnail in the gallery; timed from the
+    // click until the viewer has painted the decoded strip.
+    double openResult(const QDate& day) {
+        modeBox->setCurrentIndex(ComicSearchWidget::Date);
+        edit->setText(day.toString(Qt::ISODate));
+
+        QKeyEvent enter(QEvent::KeyPress, Qt::Key_Return, Qt::NoModifier);
+        QApplication::sendEvent(edit, &enter);
+
+        QElapsedTimer timer;
+        timer.start();
+        while (gallery->count() == 0) {
+            if (timer.elapsed() > TIMEOUT_MS) return -1;
+            QCoreApplication::processEvents();
+        }
+
+        QListWidgetItem* item = gallery->item(0);
+        gallery->scrollToItem(item);
+
+        QWidget* viewport = gallery->viewport();
+        const QPointF pos = gallery->visualItemRect(item).center();
+        const QPointF global = viewport->mapToGlobal(pos);
+
+        const auto click = [&] {
+            QMouseEvent press(QEvent::MouseButtonPress, pos, global, Qt::LeftButton,
+                              Qt::LeftButton, Qt::NoModifier);
+            QMouseEvent release(QEvent::MouseButtonRelease, pos, global, Qt::LeftButton,
+                                Qt::NoButton, Qt::NoModifier);
+            QApplication::sendEvent(viewport, &press);
+            QApplication::sendEvent(viewport, &release);
+        };
+
+        return measure(viewer, click, [&] { return !viewer->isLoading(); });
+    }
+
+    // Opens a comic in the viewer tab the same way, outside of any measurement.
+    void select(const QDate& day) {
+        openResult(day);
+        QCoreApplication::processEvents();
+    }
+
+    // The Add tag prompt runs its own event loop, so it is filled in and its Add
+    // button clicked, and timed, from a timer once it is up.
+    double addThroughPrompt(ComicTagsEditorDialog* editor, const QString& tag,
+                            const std::function<bool()>& shown) {
+        double ms = -1;
+
+        QTimer::singleShot(0, editor, [&] {
+            auto* prompt = qobject_cast<QDialog*>(QApplication::activeModalWidget());
+            if (!prompt) return;
+
+            prompt->findChild<QLineEdit*>()->setText(tag);
+            QPushButton* add = button(prompt, "Add");
+            ms = measure(tags, [add] { add->click(); }, shown);
+        });
+
+        button(editor, "Add tag")->click();
+        return ms;
+    }
+
+    // Clicks Remove on the editor row showing `tag`.
+    double removeRow(ComicTagsEditorDialog* editor, const QString& tag,
+                     const std::function<bool()>& shown) {
+        for (QLineEdit* row : editor->findChildren<QLineEdit*>()) {
+            if (!row->isVisible() || row->text() != tag) continue;
+
+            QPushButton* remove = button(row->parentWidget(), "Remove");
+            return measure(tags, [remove] { remove->click(); }, shown);
+        }
+
+        return -1;
+    }
+
+    double measure(QWidget* target, const std::function<void()>& input,
+                   std::function<bool()> ready) {
+        QCoreApplication::processEvents();
+        probe.arm(target, std::move(ready));
+
+        QElapsedTimer timer;
+        timer.start();
+        input();
+
+        while (!probe.painted()) {
+            if (timer.elapsed() > TIMEOUT_MS) return -1;
+            QCoreApplication::processEvents();
+        }
+
+        return timer.nsecsElapsed() / 1e6;
+    }
+
+    // Called right after the measurement, while the probe still holds its frames.
+    void record(Scenario& scenario, double ms) const {
+        if (ms < 0) {
+            ++scenario.timeouts;
+        } else {
+            scenario.latencies.append(ms);
+        }
+
+        scenario.droppedFrames += probe.droppedFrames();
+    }
+
+    DilbertViewer& window;
+    QRandomGenerator rng;
+    PaintProbe probe;
+
+    ComicViewerWidget* viewer;
+    ComicSearchWidget* search;
+    ComicTagsWidget* tags;
+    QComboBox* modeBox;
+    QLineEdit* edit;
+    QListWidget* gallery;
+};
+
+int usage() {
+    std::fprintf(stderr,
+                 "usage: dilbert-latency [--events N] [--seed N] [--budget SCENARIO=MS]...\n");
+    return 2;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    // Real widgets and real paints, just no display.
+    if (!qEnvironmentVariableIsSet("QT_QPA_PLATFORM")) qputenv("QT_QPA_PLATFORM", "offscreen");
+
+    QApplication app(argc, argv);
+
+    // p95 budgets in milliseconds.
+    QList<Scenario> scenarios = {
+        {"navigate", 50, {}},
+        {"search", 150, {}},
+        {"open", 50, {}},
+        {"tag-click", 150, {}},
+        {"tag-edit", 50, {}},
+    };
+
+    int events = 2000;
+    quint32 seed = 1;
+
+    const QStringList args = app.arguments().mid(1);
+    for (qsizetype i = 0; i < args.size(); ++i) {
+        if (i + 1 >= args.size()) return usage();
+
+        const QString& value = args[++i];
+        bool ok = false;
+
+        if (args[i - 1] == "--events") {
+            events = value.toInt(&ok);
+        } else if (args[i - 1] == "--seed") {
+            seed = value.toUInt(&ok);
+        } else if (args[i - 1] == "--budget") {
+            const QString name = value.section('=', 0, 0);
+            const double budget = value.section('=', 1).toDouble(&ok);
+            auto it = std::find_if(scenarios.begin(), scenarios.end(),
+                                   [&](const Scenario& s) { return name == s.name; });
+            if (it == scenarios.end()) ok = false;
+            if (ok) it->budgetMs = budget;
+        }
+
+        if (!ok) return usage();
+    }
+
+    QTemporaryDir dir;
+    QRandomGenerator rng(seed);
+    const ComicLibrary library(dir.path());
+
+    if (!dir.isValid() || !generateLibrary(library, rng)) {
+        std::fprintf(stderr, "failed to generate a library in %s\n", qPrintable(dir.path()));
+        return 1;
+    }
+
+    DilbertViewer window(library.root());
+    window.show();
+    QCoreApplication::processEvents();
+
+    Harness harness(window, seed);
+    harness.navigate(scenarios[0], events);
+    harness.searchResults(scenarios[1], events / 4);
+    harness.openResults(scenarios[2], events / 4);
+    harness.tagClicks(scenarios[3], events / 4);
+    harness.tagEdits(scenarios[4], events / 2);
+
+    std::printf("%-10s %7s %8s %8s %8s %8s %8s %8s %9s\n", "scenario", "events", "p50 ms",
+                "p95 ms", "p99 ms", "max ms", "dropped", "timeouts", "budget ms");
+
+    bool withinBudget = true;
+    for (Scenario& scenario : scenarios) {
+        std::sort(scenario.latencies.begin(), scenario.latencies.end());
+
+        const double p95 = percentile(scenario.latencies, 0.95);
+        const bool ok = scenario.timeouts == 0 && p95 <= scenario.budgetMs;
+        withinBudget = withinBudget && ok;
+
+        std::printf("%-10s %7lld %8.2f %8.2f %8.2f %8.2f %8lld %8d %9.0f%s\n", scenario.name,
+                    static_cast<long long>(scenario.latencies.size() + scenario.timeouts),
+                    percentile(scenario.latencies, 0.5), p95,
+                    percentile(scenario.latencies, 0.99),
+                    scenario.latencies.isEmpty() ? 0.0 : scenario.latencies.last(),
+                    static_cast<long long>(scenario.droppedFrames), scenario.timeouts,
+                    scenario.budgetMs, ok ? "" : "  OVER");
+    }
+
+    return withinBudget ? 0 : 1;
+}
@@ -0,0 +1,197 @@
+// dilbert-query: answers tag, date, range and transcript lookups against a comic
+// library without starting the GUI, one NDJSON object per line on stdout.
+//
+//   dilbert-query [--library DIR] [QUERY...]
+//
+// Queries come from the arguments, or one per line from stdin when there are none:
+//   tag:<name>  date:<yyyy-MM-dd>  range:<yyyy-MM-dd>..<yyyy-MM-dd>  text:<substring>
+//
+// Every match is printed as {"query":...,"date":...,"path":...}, followed by a
+// {"query":...,"count":N} line once the query is done, or {"query":...,"error":...}.
+//
+// The database is opened read-only and never created or migrated; if it cannot be
+// opened the reason goes to stderr and the exit status is 1.
+
+#include <QCoreApplication>
+#include <QDate>
+#include <QString>
+#include <QStringList>
+#include <cstdio>
+#include <string>
+
+#include "ComicLibrary.h"
+#include "ComicRepository.h"
+
+namespace {
+
+// Matches are printed as they are stepped out of SQLite, this many rows at a time.
+constexpr qsizetype PAGE_SIZE = 256;
+
+void appendJsonString(std::string& out, const QString& value) {
+    const QByteArray utf8 = value.toUtf8();
+
+    out += '"';
+    for (const char c : utf8) {
+        switch (c) {
+            case '"':
+                out += "\\\"";
+                break;
+            case '\\':
+                out += "\\\\";
+                break;
+            case '\n':
+                out += "\\n";
+                break;
+            case '\r':
+                out += "\\r";
+                break;
+            case '\t':
+                out += "\\t";
+                break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char escaped[8];
+                    std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                    out += escaped;
+                } else {
+                    out += c;
+                }
+        }
+    }
+    out += '"';
+}
+
+class QueryRunner {
+public:
+    QueryRunner(const ComicLibrary& library, const ComicRepository& repo)
+        : library(library), repo(repo) {}
+
+    void run(const QString& query) {
+        QString error;
+        ComicCursor comics = lookup(query, error);
+
+        if (!error.isEmpty()) {
+            begin(query);
+            line += ",\"error\":";
+            appendJsonString(line, error);
+            end();
+            return;
+        }
+
+        while (!comics.atEnd()) {
+            for (const ComicItem& comic : comics.nextPage(PAGE_SIZE)) {
+                begin(query);
+                line += ",\"date\":\"";
+                line += comic.date.toString(Qt::ISODate).toStdString();
+                line += "\",\"path\":";
+                appendJsonString(line, library.resolve(comic.path));
+                end();
+            }
+        }
+
+        begin(query);
+        line += ",\"count\":" + std::to_string(comics.rowsRead());
+        end();
+    }
+
+private:
+    ComicCursor lookup(const QString& query, QString& error) const {
+        const qsizetype colon = query.indexOf(':');
+        const QString kind = query.left(colon);
+        const QString arg = colon < 0 ? QString() : query.mid(colon + 1).trimmed();
+
+        if (colon < 0 || arg.isEmpty()) {
+            error = "expected <kind>:<value>";
+        } else if (kind == "tag") {
+            return repo.comicsForTag(arg);
+        } else if (kind == "text") {
+            return repo.comicsForTranscript(arg);
+        } else if (kind == "date") {
+            const QDate date = QDate::fromString(arg, Qt::ISODate);
+            if (date.isValid()) return repo.comicsForDate(date.toString(Qt::ISODate));
+            error = "invalid date";
+        } else if (kind == "range") {
+            const QStringList bounds = arg.split("..");
+            const QDate from = QDate::fromString(bounds.value(0).trimmed(), Qt::ISODate);
+            const QDate to = QDate::fromString(bounds.value(1).trimmed(), Qt::ISODate);
+            if (bounds.size() == 2 && from.isValid() && to.isValid())
+                return repo.comicsInRange(from, to);
+            error = "expected range:<from>..<to>";
+        } else {
+            error = "unknown query kind: " + kind;
+        }
+
+        return {};
+    }
+
+    void begin(const QString& query) {
+        line += "{\"query\":";
+        appendJsonString(line, query);
+    }
+
+    void end() {
+        line += "}\n";
+        std::fwrite(line.data(), 1, line.size(), stdout);
+        line.clear();
+    }
+
+    const ComicLibrary& library;
+    const ComicRepository& repo;
+    std::string line;
+};
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    // Needed for the SQL driver plugin; no GUI is initialised.
+    QCoreApplication app(argc, argv);
+
+    QStringList args = app.arguments().mid(1);
+    QString root = "./Dilbert";
+
+    const qsizetype libraryArg = args.indexOf("--library");
+    if (libraryArg >= 0) {
+        if (libraryArg + 1 >= args.size()) {
+            std::fprintf(stderr, "usage: dilbert-query [--library DIR] [QUERY...]\n");
+            return 2;
+        }
+        root = args[libraryArg + 1];
+        args.remove(libraryArg, 2);
+    }
+
+    const ComicLibrary library(root);
+    // Lookups only: never create, migrate or prune a library that is not there.
+    const ComicRepository repo(library.databasePath(), ComicRepository::ReadOnly);
+    if (!repo.isOpen()) {
+        std::fprintf(stderr, "cannot open %s: %s\n", qPrintable(library.databasePath()),
+                     qPrintable(repo.openError()));
+        return 1;
+    }
+
+    QueryRunner runner(library, repo);
+
+    std::setvbuf(stdout, nullptr, _IOFBF, 1 << 16);
+
+    if (!args.isEmpty()) {
+        for (const QString& query : std::as_const(args)) runner.run(query);
+        return 0;
+    }
+
+    // Results are flushed per query so a caller driving us through a pipe can read
+    // each answer before sending the next lookup.
+    std::string input;
+    char buffer[4096];
+    while (std::fgets(buffer, sizeof(buffer), stdin)) {
+        input += buffer;
+        if (input.back() != '\n' && !std::feof(stdin)) continue;
+
+        const QString query = QString::fromUtf8(input).trimmed();
+        input.clear();
+
+        if (query.isEmpty()) continue;
+        runner.run(query);
+        std::fflush(stdout);
+    }
+
+    return 0;
+}
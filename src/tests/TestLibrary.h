@@ -0,0 +1,102 @@
+#pragma once
+#include <QDate>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <cstdio>
+
+#include "ComicRepository.h"
+
+// Builds a throwaway metadata database for the tests: migrated by the repository,
+// then filled through a connection of its own, as the downloader and the tag editor
+// would, and ANALYZEd so the planner works from real statistics. Open it with a new
+// ComicRepository afterwards.
+//
+// Comics start on 1989-04-16, one a day, each linked to three of the tags "tag 1" to
+// "tag 60". Days that are a multiple of five have no indexed image, and multiples of
+// four no panels.
+namespace TestLibrary {
+
+constexpr int TAGS = 60;
+constexpr int LINKS_PER_COMIC = 3;
+
+inline bool exec(QSqlQuery& q, const QString& sql = {}) {
+    if (sql.isEmpty() ? q.exec() : q.exec(sql)) return true;
+    std::fprintf(stderr, "cannot seed: %s\n", qPrintable(q.lastError().text()));
+    return false;
+}
+
+inline bool insertRows(const QSqlDatabase& db, int comics) {
+    QSqlQuery q(db);
+    if (!exec(q, "BEGIN")) return false;
+
+    QSqlQuery tag(db);
+    tag.prepare("INSERT INTO tags(name) VALUES(:name)");
+
+    for (int t = 1; t <= TAGS; ++t) {
+        tag.bindValue(":name", QString("tag %1").arg(t));
+        if (!exec(tag)) return false;
+    }
+
+    QSqlQuery comic(db);
+    comic.prepare("INSERT INTO comics(date, image_path, transcript) VALUES(:date, :path, :text)");
+    QSqlQuery link(db);
+    link.prepare("INSERT OR IGNORE INTO comic_tags(comic_date, tag_id) VALUES(:date, :tagId)");
+
+    const QDate first(1989, 4, 16);
+    for (int i = 0; i < comics; ++i) {
+        const QDate date = first.addDays(i);
+        const QString iso = date.toString(Qt::ISODate);
+
+        comic.bindValue(":date", iso);
+        comic.bindValue(":path", QString("%1/%2.png").arg(date.year()).arg(iso));
+        comic.bindValue(":text", "transcript of " + iso);
+        if (!exec(comic)) return false;
+
+        for (int l = 0; l < LINKS_PER_COMIC; ++l) {
+            link.bindValue(":date", iso);
+            link.bindValue(":tagId", 1 + (i * 7 + l * 13) % TAGS);
+            if (!exec(link)) return false;
+        }
+    }
+
+    return exec(q,
+                "INSERT INTO comic_images(day, width, height, file_size, color_type, modified) "
+                "SELECT day, 900, 280, 40000, 0, 0 FROM comics WHERE day % 5 != 0") &&
+           exec(q,
+                "INSERT INTO comic_panels(comic_date, rects) "
+                "SELECT date, '' FROM comics WHERE day % 4 != 0") &&
+           exec(q, "COMMIT") && exec(q, "ANALYZE");
+}
+
+inline bool create(const QString& dbPath, int comics) {
+    {
+        const ComicRepository created(dbPath);
+        if (!created.isOpen() || created.schemaVersion() == 0) {
+            std::fprintf(stderr, "cannot create the database: %s\n",
+                         qPrintable(created.openError()));
+            return false;
+        }
+    }
+
+    const QString name = "seed";
+    bool ok = false;
+
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", name);
+        db.setDatabaseName(dbPath);
+
+        if (!db.open()) {
+            std::fprintf(stderr, "cannot open for seeding: %s\n",
+                         qPrintable(db.lastError().text()));
+        } else {
+            ok = insertRows(db, comics);
+            db.close();
+        }
+    }
+
+    QSqlDatabase::removeDatabase(name);
+    return ok;
+}
+
+}  // namespace TestLibrary
@@ -0,0 +1,90 @@
+// dilbert-cache-test: checks that a search is answered from the repository's result
+// cache when it is repeated, even if the first run only read its first page the way
+// the gallery does, and that the replayed result matches one read from the database.
+//
+//   ctest --test-dir out   (or: make test)
+
+#include <QCoreApplication>
+#include <QTemporaryDir>
+#include <cstdio>
+
+#include "ComicRepository.h"
+#include "TestLibrary.h"
+
+namespace {
+
+constexpr int COMICS = 1000;
+constexpr qsizetype PAGE = 10;
+
+QList<QDate> readAll(ComicCursor& cursor) {
+    QList<QDate> dates;
+    while (!cursor.atEnd()) {
+        for (const ComicItem& comic : cursor.nextPage(PAGE)) dates.append(comic.date);
+    }
+    return dates;
+}
+
+int failures = 0;
+
+void expect(bool ok, const char* what) {
+    if (ok) return;
+    std::fprintf(stderr, "FAIL: %s\n", what);
+    ++failures;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    // Needed for the SQL driver plugin; no GUI is initialised.
+    QCoreApplication app(argc, argv);
+
+    QTemporaryDir dir;
+    if (!dir.isValid()) {
+        std::fprintf(stderr, "cannot create a temporary directory\n");
+        return 2;
+    }
+
+    const QString dbPath = dir.filePath("metadata.db");
+    if (!TestLibrary::create(dbPath, COMICS)) return 2;
+
+    ComicRepository repo(dbPath);
+    if (!repo.isOpen()) {
+        std::fprintf(stderr, "cannot open the database: %s\n", qPrintable(repo.openError()));
+        return 2;
+    }
+
+    const QString tag = "tag 1";
+
+    // What the search returns straight from the database.
+    ComicCursor fresh = repo.comicsForTag(tag);
+    const QList<QDate> expected = readAll(fresh);
+    expect(expected.size() > 3 * PAGE, "the search spans several pages");
+    expect(repo.cacheMisses() == 1 && repo.cacheHits() == 0, "the first search misses");
+
+    // Start over after a write, and read only the first page before searching again.
+    repo.invalidateResults();
+    {
+        ComicCursor partial = repo.comicsForTag(tag);
+        expect(partial.nextPage(PAGE).size() == PAGE, "the first page is full");
+        expect(!partial.atEnd(), "the partly read search has more pages");
+    }
+    expect(repo.cacheMisses() == 2, "a search after a write misses");
+
+    ComicCursor resumed = repo.comicsForTag(tag);
+    expect(repo.cacheHits() == 1, "a partly read search is a hit when repeated");
+    expect(readAll(resumed) == expected, "the repeated search returns the whole result");
+
+    // Reading it to the end cached the rest, so now it replays entirely from memory.
+    ComicCursor replayed = repo.comicsForTag(tag);
+    expect(repo.cacheHits() == 2 && repo.cacheMisses() == 2, "a search read to the end hits");
+    expect(readAll(replayed) == expected, "the replayed search matches the database");
+
+    // Writes make cached results stale; the second comic does not carry the tag yet.
+    expect(repo.addTagToComic(QDate(1989, 4, 17), tag), "the tag can be added");
+    ComicCursor afterWrite = repo.comicsForTag(tag);
+    expect(repo.cacheMisses() == 3, "a search after a write misses");
+    expect(readAll(afterWrite).size() == expected.size() + 1, "the write shows up");
+
+    std::printf("%d failed checks\n", failures);
+    return failures == 0 ? 0 : 1;
+}